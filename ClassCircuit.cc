@@ -10,8 +10,8 @@
  *
  * An important thing to understand: we will use a special Gate type called a PI to represent
  * the circuit's primary inputs. This isn't really a logic gate, it's just a way of 
- * making it easy to access the inputs. So, when you call \a getPIGates() you will get a vector of
- * pointers to the special PI gates.
+ * making it easy to access the inputs. So, when you call \a getPIGates() you will get a view of the
+ * list of pointers to the special PI gates.
  * 
  * We don't use a special structure for the primary outputs (POs); instead we simply maintain a 
  * list of which gates drive the output values. So when you call \a getPOGates() you will get
@@ -33,9 +33,18 @@ Circuit::Circuit() {}
  *  \param ID a unique ID number for the gate (primarily used while parsing the input source file)
  *  \param gt the type of gate, using the GATE_* marcos defined in ClassGate.h
  *  \note This function should only need to be run by the parser.
+ *  Will fail an assertion if a gate with the same name already exists, which only happens
+ *  for a name declared twice in the .bench file: setupCircuit() picks FANOUT branch names
+ *  that are not in use.
  */
-void Circuit::newGate(string name, int ID, int gt) {
-	Gate* g = new Gate(name, ID, gt);
+void Circuit::newGate(const string& name, int ID, int gt) {
+	int sym = gateNames.intern(name);
+	if (!gateNames.defineGate(sym, gates.size())) {
+		cout << "ERROR: Duplicate gate name: " << name << endl;
+		assert(false);
+	}
+
+	Gate* g = new Gate(&gateNames.getName(sym), ID, gt);
 	gates.push_back(g);
 
 	if (gt == GATE_PI)
@@ -54,12 +63,31 @@ Gate* Circuit::getGate(int i) {
 	return gates[i];
 }
 
+/** \brief Get pointer to the gate with ID \a ID
+ *  \param ID gate ID (see Gate::get_gateID())
+ *  \return Pointer to the Gate with this ID
+ */
+Gate* Circuit::getGateByID(int ID) {
+	Gate* g = getGate(ID);
+	assert(g->get_gateID() == ID);
+	return g;
+}
+
+/** \brief Interns a signal name in the circuit's NameTable, so that it is stored only once.
+ *  \param name The name of a signal, which may not have a gate yet
+ *  \return The name's symbol ID (see findGateBySymbol())
+ *  \note This function should only need to be run by the parser.
+ */
+int Circuit::internName(const string& name) {
+	return gateNames.intern(name);
+}
+
 /** \brief Record the name of a primary output of this circuit.
  *  \param n Name of the output signal
  *  \note This function should only need to be run by the parser.
  */
-void Circuit::addOutputName(string n) {
-	outputNames.push_back(n);
+void Circuit::addOutputName(const string& n) {
+	outputSymbols.push_back(gateNames.intern(n));
 }
 
 /** \brief Print the circuit
@@ -83,46 +111,54 @@ void Circuit::printAllGates() {
 /** \brief Returns a pointer to the Gate in this circuit with output name \a name.
  *  \param name A string containing the name of the gate requested
  *  \return Pointer to the Gate with output given by \a name
- *  Will fail an assertion if multiple gates with that name are found, or if none are.
- *  \note This function should probably only need to be called by the parser.
+ *  Will fail an assertion if no gate with that name is found. (Duplicate names are
+ *  rejected by newGate(), so at most one can exist.) The lookup uses the circuit's
+ *  NameTable, so it takes constant time.
  */
-Gate* Circuit::findGateByName(string name) {
-	Gate* res;
-	bool found = false;
-
-	for (int i=0; i<gates.size(); i++) {
-		if (gates[i]->get_outputName().compare(name) == 0) {
-			res = gates[i];
-			assert(!found);
-			found = true;
-		}
+Gate* Circuit::findGateByName(const string& name) {
+	int sym = gateNames.lookup(name);
+	if (sym == SYMBOL_UNDEFINED) {
+		cout << "ERROR: Cannot find: " << name << endl;
+		assert(false);
 	}
+	return findGateBySymbol(sym);
+}
 
-	if (!found)
-		cout << "ERROR: Cannot find: " << name << endl;
+/** \brief Returns a pointer to the Gate in this circuit whose output name has symbol ID \a sym.
+ *  \param sym A name interned in the circuit's NameTable (see internName())
+ *  \return Pointer to the Gate with that output name
+ *  Will fail an assertion if no gate has that name.
+ */
+Gate* Circuit::findGateBySymbol(int sym) {
+	int i = gateNames.getGateID(sym);
+
+	if (i == SYMBOL_UNDEFINED)
+		cout << "ERROR: Cannot find: " << gateNames.getName(sym) << endl;
  
-	assert(found);
-	return res;
+	assert(i != SYMBOL_UNDEFINED);
+	return gates[i];
 }
 
 /** \brief Sets up the circuit data structures after parsing is complete.
- *  Run this once after parsing, before using the data structure.
+ *  Run this once after parsing, before using the data structure. As its last steps,
+ *  this builds the circuit's Netlist (see getNetlist()), which levelizes the circuit: it
+ *  sets each gate's depth and stops with an error if the circuit has a combinational loop.
+ *  The gates in level order are then available from getLevelOrder().
  *  The handout \a main.cc code already does this; you do not need to add it yourself.
  */
 void Circuit::setupCircuit() {
 
 	// set-up the vector of output gates based on their pre-stored names
-	for (int i=0; i<outputNames.size(); i++) {
-		outputGates.push_back(findGateByName(outputNames[i]));
+	for (int i=0; i<outputSymbols.size(); i++) {
+		outputGates.push_back(findGateBySymbol(outputSymbols[i]));
 	}
 
 	// set input and output pointers of each gate
 	for (int i=0; i<gates.size(); i++) {
 		Gate* g = gates[i];
-		vector<string> names = g->get_gateInputNames();
+		const vector<int>& names = g->get_gateInputSymbols();
 		for (int j=0; j<names.size(); j++) {
-			string n = names[j];
-			Gate* inGate = findGateByName(n);
+			Gate* inGate = findGateBySymbol(names[j]);
 			inGate->set_gateOutput(g);
 			g->set_gateInput(inGate);
 		}
@@ -150,7 +186,9 @@ void Circuit::setupCircuit() {
 	// is a gate output.
 	for (int i=0; i<gates.size(); i++) {
 		Gate* g = gates[i];
-		vector<Gate*> go = g->get_gateOutputs();
+		// a copy, because the loop below rewrites g's output list
+		GateView goView = g->get_gateOutputs();
+		vector<Gate*> go(goView.begin(), goView.end());
 		
 		if ((g->get_gateType() != GATE_FANOUT) && (go.size() > 1)) {        
 			for (int j=0; j<go.size(); j++) {   
@@ -160,9 +198,17 @@ void Circuit::setupCircuit() {
 				// After:
 				//    g --> newG --> go[j], where newG is a gate of type FANOUT
 
+				// The branch is named <stem>_<j>. If the .bench file already uses that
+				// name for a net, "_1", "_2", ... is added until the name is free.
 				ostringstream ss;
 				ss << g->get_outputName() << "_" << (int)j;
-				newGate(ss.str(), gates.size(), GATE_FANOUT);        
+				string branchName = ss.str();
+				for (int k=1; gateNames.lookup(branchName) != SYMBOL_UNDEFINED; k++) {
+					ostringstream suffixed;
+					suffixed << ss.str() << "_" << k;
+					branchName = suffixed.str();
+				}
+				newGate(branchName, gates.size(), GATE_FANOUT);        
 				Gate* newFanoutGate = gates.back();
 
 				// change g's output[j] to point to newFanoutGate
@@ -181,6 +227,57 @@ void Circuit::setupCircuit() {
 	}
 
 	checkPointerConsistency();
+
+	// Freeze the circuit into its compact form. After this, no gates may be added.
+	netlist.build(gates, inputGates, outputGates);
+	setLevelOrder();
+}
+
+/** \brief Sets up the circuit from a netlist cache, instead of parsing and setupCircuit().
+ *  \param cache A loaded cache (see NetlistCache::isLoaded()), written by NetlistCache::write()
+ *  after setupCircuit() on the same .bench file.
+ *  The gates, including the FANOUT gates, get the same IDs, names and connections as
+ *  setupCircuit() gave them, and the Netlist is loaded with its levels from the cache, so the
+ *  circuit is the same as if the .bench file had been parsed. Run this on a new Circuit, once.
+ */
+void Circuit::setupFromCache(const NetlistCache& cache) {
+	assert(gates.empty());
+	int n = cache.getNumberGates();
+	gateNames.reserve(n);
+	gates.reserve(n);
+	for (int i=0; i<n; i++)
+		newGate(cache.getName(i), i, cache.getType(i));
+
+	// newGate() lists the PIs in ID order; use the order in the cache, as for the POs.
+	inputGates.clear();
+	for (int i=0; i<cache.getNumberPIs(); i++)
+		inputGates.push_back(gates[cache.getPIs()[i]]);
+	for (int i=0; i<cache.getNumberPOs(); i++)
+		outputGates.push_back(gates[cache.getPOs()[i]]);
+
+	// connect the gates by ID, in the same order as before
+	const int32_t* faninStart = cache.getFaninStart();
+	const int32_t* faninList = cache.getFaninList();
+	const int32_t* fanoutStart = cache.getFanoutStart();
+	const int32_t* fanoutList = cache.getFanoutList();
+	for (int i=0; i<n; i++) {
+		for (int k=faninStart[i]; k<faninStart[i+1]; k++)
+			gates[i]->set_gateInput(gates[faninList[k]]);
+		for (int k=fanoutStart[i]; k<fanoutStart[i+1]; k++)
+			gates[i]->set_gateOutput(gates[fanoutList[k]]);
+	}
+
+	netlist.load(gates, cache);
+	setLevelOrder();
+}
+
+/** \brief Private function that lists the gates in the netlist's level order (see getLevelOrder()).
+ */
+void Circuit::setLevelOrder() {
+	const vector<int>& order = netlist.getLevelOrder();
+	levelOrder.clear();
+	for (int i=0; i<order.size(); i++)
+		levelOrder.push_back(gates[order[i]]);
 }
 
 /** \brief Initializes the values of the PIs of the circuit.
@@ -237,12 +334,22 @@ void Circuit::clearGateValues() {
 }
 
 /** \brief Returns the PI (input) gates. (The PIs of the circuit).
-	\return a \a vector<Gate*> of the circuit's PIs */
-vector<Gate*> Circuit::getPIGates() { return inputGates; }
+	\return a \a GateView of the circuit's PIs (no copy is made) */
+GateView Circuit::getPIGates() { return GateView(inputGates); }
 
 /** \brief Returns the PO (output) gates. (The gates which drive the POs of the circuit.)
-	\return a \a vector<Gate*> of the circuit's POs */
-vector<Gate*> Circuit::getPOGates() { return outputGates; }
+	\return a \a GateView of the circuit's POs (no copy is made) */
+GateView Circuit::getPOGates() { return GateView(outputGates); }
+
+/** \brief Returns all gates in topological order: by depth (see Gate::getDepth()), ties broken by ID.
+	Every gate comes after all of its inputs, so evaluating the gates in this order needs no recursion.
+	\return a \a GateView of the gates in level order (no copy is made). It is only valid after setupCircuit() has run. */
+GateView Circuit::getLevelOrder() { return GateView(levelOrder); }
+
+/** \brief Returns the compact, levelized form of this circuit.
+	\return a pointer to the circuit's Netlist. It is only valid after setupCircuit() has run.
+	The Netlist shares gate values and faults with the Gates, so either view can be used. */
+Netlist* Circuit::getNetlist() { return &netlist; }
 
 /** \brief Private function for Circuit to check input and output pointers
  *   for all gates are set consistently. Just used in setting up circuit.
@@ -253,16 +360,16 @@ void Circuit::checkPointerConsistency() {
 		Gate* g = gates[i];
 	
 		// every gate in g's input list must have g in its output list
-		vector<Gate*> gi = g->get_gateInputs();
+		GateView gi = g->get_gateInputs();
 		for (int j=0; j < gi.size(); j++) {
-			vector<Gate*> gi_go = gi[j]->get_gateOutputs();
+			GateView gi_go = gi[j]->get_gateOutputs();
 			assert(find(gi_go.begin(), gi_go.end(), g) != gi_go.end());
 		}
 
 		// every gate in g's output list must have g in its input list
-		vector<Gate*> go = g->get_gateOutputs();
+		GateView go = g->get_gateOutputs();
 		for (int j=0; j < go.size(); j++) {
-			vector<Gate*> go_gi = go[j]->get_gateInputs();
+			GateView go_gi = go[j]->get_gateInputs();
 			assert(find(go_gi.begin(), go_gi.end(), g) != go_gi.end());
 		}   
 	} 
@@ -270,7 +377,7 @@ void Circuit::checkPointerConsistency() {
 	// check that fanout goes to FANOUT gates only
 	for (int i=0; i<gates.size(); i++) {
 		Gate* g = gates[i];
-		vector<Gate*> go = g->get_gateOutputs();
+		GateView go = g->get_gateOutputs();
 	
 		if (go.size() > 1) {
 			for (int j=0; j<go.size(); j++) {
@@ -2,6 +2,9 @@
 #define CLASSCIRCUIT_H
 
 #include "ClassGate.h"
+#include "ClassNameTable.h"
+#include "ClassNetlist.h"
+#include "ClassNetlistCache.h"
 #include <assert.h>  // assert
 #include <iostream>  // cout
 #include <vector>    // vector
@@ -12,26 +15,36 @@ class Circuit{
 	vector<Gate*> gates;            // Pointers to all gates in the circuit
 	vector<Gate*> outputGates;      // Pointers to all gates driving POs
 	vector<Gate*> inputGates;       // Pointers to all PIs
-	vector<string> outputNames;     // A vector with output names (only used in setup)
+	vector<Gate*> levelOrder;       // Pointers to all gates in topological (level) order, set by setupCircuit()
+	vector<int> outputSymbols;      // The output names, as symbol IDs in gateNames (only used in setup)
+	NameTable gateNames;            // Symbol table: signal name <--> gate
+	Netlist netlist;                // Compact copy of the circuit, built at the end of setupCircuit()
 	void checkPointerConsistency(); // An internal function to check that the Circuit is setup correctly.
+	void setLevelOrder();           // Sets levelOrder from the netlist; the last step of setup.
 
 	
  public:
 	Circuit();
-	void newGate(string name, int ID, int gt);
+	void newGate(const string& name, int ID, int gt);
 	Gate* getGate(int i);
-	void addOutputName(string n);
+	Gate* getGateByID(int ID);
+	int internName(const string& name);
+	void addOutputName(const string& n);
 	void printAllGates();
 	void setupCircuit();
-	Gate* findGateByName(string name);
+	void setupFromCache(const NetlistCache& cache);
+	Gate* findGateByName(const string& name);
+	Gate* findGateBySymbol(int sym);
 	void setPIValues(vector<char> inputVals);
 	vector<int> getPOValues();
 	int getNumberPIs();
 	int getNumberPOs();
 	int getNumberGates();
 	void clearGateValues(); 
-	vector<Gate*> getPIGates();
-	vector<Gate*> getPOGates();
+	GateView getPIGates();
+	GateView getPOGates();
+	GateView getLevelOrder();
+	Netlist* getNetlist();
 	void clearFaults();
 	
 };
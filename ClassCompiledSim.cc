@@ -0,0 +1,405 @@
+/** \class CompiledSim
+ * \brief A compiled-code, bit-parallel simulator for the fault-free circuit.
+ *
+ * The PatternSim interprets the netlist: for every gate and every block of patterns it looks up
+ * the gate's kernel, its inputs and their offsets. A CompiledSim instead writes out straight-line
+ * C++ for the whole levelized netlist, with one statement per gate on two-rail words (the
+ * encoding of PatternSim), compiles it into a shared object with the local C++ compiler for the
+ * local machine (-march=native), and loads it with dlopen(). Each gate's value is then a few
+ * register operations on COMPILED_SIM_BLOCK words at a time (a GCC vector); only the final
+ * values are stored.
+ *
+ * The compiler's time and memory grow much faster than linearly with the size of a function, so
+ * the gates are split, in level order, into source files of COMPILED_SIM_CHUNK gates, which are
+ * compiled in parallel and linked. A gate's inputs computed by an earlier chunk are loaded from
+ * the stored values.
+ *
+ * Compiling takes a while, so the shared objects are cached in a directory, named by a hash of
+ * the netlist structure (gate types, connections, PIs and POs, and the code generator version)
+ * and of the compiler's predefined macros for -march=native (its version and the instruction
+ * set extensions of the machine). A circuit is only compiled again if its netlist, the compiler
+ * or the machine changes. The cache directory is the one given to the constructor, or
+ * $ATPG_CACHE_DIR, or ".atpg_cache" in the current directory. The compiler is $CXX, or "g++";
+ * it is run directly, not through a shell.
+ *
+ * If the code cannot be compiled or loaded, \a isLoaded() is false, and the caller should keep
+ * using the PatternSim. The compiled simulator has no fault injection. Once it is attached to the
+ * Netlist (see Netlist::setCompiledSim()), every PatternSim on that netlist uses it in
+ * PatternSim::simulateGood(), including those inside a FaultSim.
+ */
+
+#include "ClassCompiledSim.h"
+#include <fstream>     // ofstream
+#include <sstream>     // ostringstream, istringstream
+#include <stdio.h>     // rename, remove
+#include <stdlib.h>    // getenv
+#include <fcntl.h>     // open
+#include <unistd.h>    // access, getpid, fork, execvp, pipe, dup2
+#include <sys/stat.h>  // mkdir
+#include <sys/wait.h>  // waitpid
+#include <dlfcn.h>     // dlopen, dlsym, dlclose
+#include <thread>      // hardware_concurrency
+
+// Change this whenever writeSource() changes, so that old cached libraries are not used.
+#define COMPILED_SIM_VERSION 4
+
+// Words of patterns simulated together, as one GCC vector
+#define COMPILED_SIM_BLOCK 8
+
+// Gates per generated source file. The compiler's time and memory grow faster than linearly
+// with the size of a function, and its memory with the size of a file, so the netlist is split
+// into files of this many gates, which are compiled separately (and in parallel).
+#define COMPILED_SIM_CHUNK 2000
+
+/** \brief Starts a program, without a shell.
+ *  \param args The program and its arguments; the program is looked up in $PATH
+ *  \param outputFd If not -1, the program's standard output goes to this file descriptor
+ *  \return The process ID, or -1 if the program could not be started.
+ */
+static pid_t startProgram(const vector<string>& args, int outputFd = -1) {
+	vector<char*> argv;
+	for (int i=0; i<args.size(); i++)
+		argv.push_back(const_cast<char*>(args[i].c_str()));
+	argv.push_back(NULL);
+
+	pid_t pid = fork();
+	if (pid == 0) {
+		// the child: standard input is /dev/null
+		int devNull = open("/dev/null", O_RDONLY);
+		if (devNull >= 0)
+			dup2(devNull, 0);
+		if (outputFd >= 0)
+			dup2(outputFd, 1);
+		execvp(argv[0], &argv[0]);
+		_exit(127);
+	}
+	return pid;
+}
+
+/** \brief Waits for a program started by startProgram().
+ *  \return True if it exited with status 0.
+ */
+static bool waitProgram(pid_t pid) {
+	int status;
+	if ((pid < 0) || (waitpid(pid, &status, 0) != pid))
+		return false;
+	return WIFEXITED(status) && (WEXITSTATUS(status) == 0);
+}
+
+/** \brief Runs a program, without a shell, and collects its standard output.
+ *  \param args The program and its arguments
+ *  \param output Set to what the program writes to its standard output
+ *  \return True if the program ran and exited with status 0.
+ */
+static bool runProgram(const vector<string>& args, string& output) {
+	int fd[2];
+	if (pipe(fd) != 0)
+		return false;
+	pid_t pid = startProgram(args, fd[1]);
+	close(fd[1]);
+	output.clear();
+	char buffer[4096];
+	ssize_t n;
+	while ((n = read(fd[0], buffer, sizeof(buffer))) > 0)
+		output.append(buffer, n);
+	close(fd[0]);
+	return waitProgram(pid);
+}
+
+/** \brief Loads the compiled simulator for a netlist, compiling it first if it is not cached.
+ *  \param nl The circuit's Netlist (see Circuit::getNetlist())
+ *  \param cacheDir The directory of compiled simulators; empty for the default (see the class description)
+ */
+CompiledSim::CompiledSim(const Netlist* nl, const string& cacheDir) {
+	library = NULL;
+	function = NULL;
+	hash = hashNetlist(nl);
+
+	string dir = cacheDir;
+	if (dir.empty())
+		dir = (getenv("ATPG_CACHE_DIR") != NULL) ? getenv("ATPG_CACHE_DIR") : ".atpg_cache";
+	mkdir(dir.c_str(), 0755);
+
+	// $CXX may hold arguments too (e.g. "ccache g++"); it is split on white space, not run by a shell.
+	vector<string> compiler;
+	istringstream words((getenv("CXX") != NULL) ? getenv("CXX") : "g++");
+	string word;
+	while (words >> word)
+		compiler.push_back(word);
+	if (compiler.empty())
+		compiler.push_back("g++");
+
+	// The code is built for the local machine, so the key includes the compiler's predefined
+	// macros for it: the compiler's version and every instruction set extension it may use.
+	// A cache shared by machines with different CPUs or compilers then keeps one object for each.
+	vector<string> probe = compiler;
+	const char* probeArgs[] = {"-march=native", "-dM", "-E", "-x", "c++", "/dev/null"};
+	probe.insert(probe.end(), probeArgs, probeArgs + 6);
+	string target;
+	if (!runProgram(probe, target)) {
+		cout << "WARNING: Cannot run the compiler " << compiler[0] << "; using the interpreted simulator" << endl;
+		return;
+	}
+	uint64_t key = hash;
+	for (int i=0; i<target.size(); i++) {
+		key ^= (unsigned char)target[i];
+		key *= 1099511628211ULL;
+	}
+
+	ostringstream base;
+	base << dir << "/sim_" << hex << key;
+	string libName = base.str() + ".so";
+
+	if ((access(libName.c_str(), R_OK) != 0) && !build(nl, compiler, base.str(), libName))
+		return;
+
+	library = dlopen(libName.c_str(), RTLD_NOW | RTLD_LOCAL);
+	if (library == NULL) {
+		cout << "WARNING: Cannot load " << libName << " (" << dlerror() << "); using the interpreted simulator" << endl;
+		return;
+	}
+	function = (compiledSimFunc)dlsym(library, "atpgSimulate");
+	if (function == NULL)
+		cout << "WARNING: No simulator in " << libName << "; using the interpreted simulator" << endl;
+}
+
+/** \brief Private function that writes, compiles and links the simulator.
+ *  \param nl The netlist
+ *  \param compiler The compiler command
+ *  \param base The name of the sources (see \a writeSource()) and objects, without an extension
+ *  \param libName The shared object to build
+ *  \return False, after printing a warning, if any step failed.
+ *
+ *  The sources are compiled by up to one compiler per core at a time. The shared object is
+ *  linked under a temporary name and renamed, so other runs never load a partial file.
+ */
+bool CompiledSim::build(const Netlist* nl, const vector<string>& compiler, const string& base, const string& libName) const {
+	vector<string> sources;
+	if (!writeSource(nl, base, sources)) {
+		cout << "WARNING: Cannot write the sources of " << libName << "; using the interpreted simulator" << endl;
+		for (int i=0; i<sources.size(); i++)
+			remove(sources[i].c_str());
+		return false;
+	}
+
+	cout << "Compiling the simulator: " << sources.size() << " files with " << compiler[0] << endl;
+	int maxRunning = max(1u, thread::hardware_concurrency());
+	vector<string> objects;
+	vector<pid_t> running;
+	bool ok = true;
+	for (int i=0; i<sources.size(); i++) {
+		objects.push_back(sources[i].substr(0, sources[i].size() - 3) + ".o");
+		vector<string> command = compiler;
+		const char* compileArgs[] = {"-O2", "-march=native", "-fPIC", "-c", "-o"};
+		command.insert(command.end(), compileArgs, compileArgs + 5);
+		command.push_back(objects[i]);
+		command.push_back(sources[i]);
+		if (running.size() == maxRunning) {
+			ok = waitProgram(running[0]) && ok;
+			running.erase(running.begin());
+		}
+		running.push_back(startProgram(command));
+	}
+	for (int i=0; i<running.size(); i++)
+		ok = waitProgram(running[i]) && ok;
+
+	ostringstream tmpName;
+	tmpName << libName << ".tmp" << getpid();
+	if (ok) {
+		vector<string> command = compiler;
+		command.push_back("-shared");
+		command.push_back("-o");
+		command.push_back(tmpName.str());
+		command.insert(command.end(), objects.begin(), objects.end());
+		ok = waitProgram(startProgram(command)) && (rename(tmpName.str().c_str(), libName.c_str()) == 0);
+	}
+	for (int i=0; i<objects.size(); i++)
+		remove(objects[i].c_str());
+	if (!ok) {
+		cout << "WARNING: Cannot compile " << sources[0] << "; using the interpreted simulator" << endl;
+		remove(tmpName.str().c_str());
+	}
+	return ok;
+}
+
+/** \brief Destructor: unloads the shared object. */
+CompiledSim::~CompiledSim() {
+	if (library != NULL)
+		dlclose(library);
+}
+
+/** \brief Hashes everything about a netlist that the compiled code depends on (64-bit FNV-1a).
+ *  \param nl The netlist
+ *  \return The hash. Gate values, faults and SCOAP numbers are not included.
+ */
+uint64_t CompiledSim::hashNetlist(const Netlist* nl) {
+	uint64_t h = 14695981039346656037ULL;
+	auto mix = [&h](int v) {
+		for (int i=0; i<4; i++) {
+			h ^= (v >> (8*i)) & 0xff;
+			h *= 1099511628211ULL;
+		}
+	};
+
+	mix(COMPILED_SIM_VERSION);
+	mix(nl->getNumberGates());
+	for (int g=0; g<nl->getNumberGates(); g++) {
+		mix(nl->getType(g));
+		mix(nl->faninEnd(g) - nl->faninBegin(g));
+		for (int k=nl->faninBegin(g); k<nl->faninEnd(g); k++)
+			mix(nl->faninAt(k));
+	}
+	const vector<int>& pi = nl->getPIs();
+	mix(pi.size());
+	for (int i=0; i<pi.size(); i++)
+		mix(pi[i]);
+	const vector<int>& po = nl->getPOs();
+	mix(po.size());
+	for (int i=0; i<po.size(); i++)
+		mix(po[i]);
+	return h;
+}
+
+/** \brief Private function that writes the C++ sources of the simulator.
+ *  \param nl The netlist
+ *  \param base The name of the sources, without an extension
+ *  \param sources Set to the names of the files written (or started)
+ *  \return False if a file could not be written completely.
+ *
+ *  The gates are split, in level order, into chunks of COMPILED_SIM_CHUNK gates, each in its own
+ *  file base_<k>.cc. There the template simulateChunk() computes each gate into a pair of locals
+ *  (z<ID>, o<ID>) of type T, and stores them in \a zero and \a one (gate \a g's word \a w at index
+ *  g*numWords + w); an input computed by an earlier chunk is loaded from there. The function
+ *  atpgChunk<k>() runs it on COMPILED_SIM_BLOCK words at a time with T a GCC vector, and on the
+ *  remaining words one at a time. The function atpgSimulate(), in base.cc, runs the chunks in order.
+ */
+bool CompiledSim::writeSource(const Netlist* nl, const string& base, vector<string>& sources) const {
+	vector<int> piIndex(nl->getNumberGates(), -1);
+	const vector<int>& pi = nl->getPIs();
+	for (int i=0; i<pi.size(); i++)
+		piIndex[pi[i]] = i;
+
+	// available[g] is the chunk in which gate g's locals are defined (computed or loaded), or -1
+	vector<int> available(nl->getNumberGates(), -1);
+	const vector<int>& order = nl->getLevelOrder();
+	int numChunks = (order.size() + COMPILED_SIM_CHUNK - 1) / COMPILED_SIM_CHUNK;
+	for (int chunk=0; chunk<numChunks; chunk++) {
+		sources.push_back(base + "_" + to_string(chunk) + ".cc");
+		ofstream out(sources.back().c_str());
+		out << "// Generated by the ATPG tool (CompiledSim); netlist hash " << hex << hash << dec << ", chunk " << chunk << endl;
+		out << "#include <stdint.h>" << endl;
+		out << "#include <string.h>" << endl;
+		out << "typedef uint64_t W;" << endl;
+		out << "typedef W V __attribute__((vector_size(" << COMPILED_SIM_BLOCK << " * sizeof(W))));" << endl;
+		out << "template <class T> static inline T load(const W* p) { T v; memcpy(&v, p, sizeof(T)); return v; }" << endl;
+		out << "template <class T> static inline void store(W* p, T v) { memcpy(p, &v, sizeof(T)); }" << endl;
+		out << "template <class T> static void simulateChunk(const W* piZero, const W* piOne, W* zero, W* one, int n, int w) {" << endl;
+
+		int end = min((int)order.size(), (chunk + 1) * COMPILED_SIM_CHUNK);
+		for (int i=chunk*COMPILED_SIM_CHUNK; i<end; i++) {
+			int g = order[i];
+			char t = nl->getType(g);
+			int first = nl->faninBegin(g), last = nl->faninEnd(g);
+			for (int k=first; k<last; k++) {
+				int in = nl->faninAt(k);
+				if (available[in] == chunk)
+					continue;
+				out << "  const T z" << in << " = load<T>(zero + " << in << "*n + w), o" << in << " = load<T>(one + " << in << "*n + w);" << endl;
+				available[in] = chunk;
+			}
+			available[g] = chunk;
+
+			string z, o;   // the zero-rail and one-rail expressions
+			string in0 = (last > first) ? to_string(nl->faninAt(first)) : "";
+
+			switch (t) {
+			case GATE_PI:
+				// a gate of type PI that is not a PI of the circuit stays X, as in PatternSim
+				if (piIndex[g] < 0) {
+					z = "T()";
+					o = "T()";
+				}
+				else {
+					z = "load<T>(piZero + " + to_string(piIndex[g]) + "*n + w)";
+					o = "load<T>(piOne + " + to_string(piIndex[g]) + "*n + w)";
+				}
+				break;
+			case GATE_BUFF:
+			case GATE_FANOUT:
+				z = "z" + in0;
+				o = "o" + in0;
+				break;
+			case GATE_NOT:
+				z = "o" + in0;
+				o = "z" + in0;
+				break;
+			case GATE_AND:
+			case GATE_NAND:
+			case GATE_OR:
+			case GATE_NOR: {
+				// AND: zero if any input is zero, one if all are one; OR is the dual
+				bool isAnd = (t == GATE_AND) || (t == GATE_NAND);
+				z = "z" + in0;
+				o = "o" + in0;
+				for (int k=first+1; k<last; k++) {
+					z += (isAnd ? " | z" : " & z") + to_string(nl->faninAt(k));
+					o += (isAnd ? " & o" : " | o") + to_string(nl->faninAt(k));
+				}
+				if ((t == GATE_NAND) || (t == GATE_NOR))
+					swap(z, o);
+				break;
+			}
+			case GATE_XOR:
+			case GATE_XNOR: {
+				// parity, folded one input at a time into locals p<ID>_<k>; X if any input is X
+				z = "z" + in0;
+				o = "o" + in0;
+				for (int k=first+1; k<last; k++) {
+					string iz = "z" + to_string(nl->faninAt(k)), io = "o" + to_string(nl->faninAt(k));
+					string name = "p" + to_string(g) + "_" + to_string(k - first);
+					out << "  const T " << name << "z = (" << z << " & " << iz << ") | (" << o << " & " << io << "), "
+					    << name << "o = (" << z << " & " << io << ") | (" << o << " & " << iz << ");" << endl;
+					z = name + "z";
+					o = name + "o";
+				}
+				if (t == GATE_XNOR)
+					swap(z, o);
+				break;
+			}
+			default:
+				assert(false);
+			}
+
+			out << "  const T z" << g << " = " << z << ", o" << g << " = " << o << ";" << endl;
+			out << "  store(zero + " << g << "*n + w, z" << g << "); store(one + " << g << "*n + w, o" << g << ");" << endl;
+		}
+		out << "}" << endl;
+
+		out << "extern \"C\" void atpgChunk" << chunk << "(const W* piZero, const W* piOne, W* zero, W* one, int n) {" << endl;
+		out << "  int w = 0;" << endl;
+		out << "  for (; w + " << COMPILED_SIM_BLOCK << " <= n; w += " << COMPILED_SIM_BLOCK << ")" << endl;
+		out << "    simulateChunk<V>(piZero, piOne, zero, one, n, w);" << endl;
+		out << "  for (; w < n; w++)" << endl;
+		out << "    simulateChunk<W>(piZero, piOne, zero, one, n, w);" << endl;
+		out << "}" << endl;
+
+		// a full disk shows up as a failed stream; the caller then uses the interpreted simulator
+		out.close();
+		if (out.fail())
+			return false;
+	}
+
+	sources.push_back(base + ".cc");
+	ofstream out(sources.back().c_str());
+	out << "// Generated by the ATPG tool (CompiledSim); netlist hash " << hex << hash << dec << endl;
+	out << "#include <stdint.h>" << endl;
+	out << "typedef uint64_t W;" << endl;
+	for (int chunk=0; chunk<numChunks; chunk++)
+		out << "extern \"C\" void atpgChunk" << chunk << "(const W* piZero, const W* piOne, W* zero, W* one, int n);" << endl;
+	out << "extern \"C\" void atpgSimulate(const W* piZero, const W* piOne, W* zero, W* one, int n) {" << endl;
+	for (int chunk=0; chunk<numChunks; chunk++)
+		out << "  atpgChunk" << chunk << "(piZero, piOne, zero, one, n);" << endl;
+	out << "}" << endl;
+	out.close();
+	return !out.fail();
+}
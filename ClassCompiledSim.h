@@ -0,0 +1,37 @@
+#ifndef CLASSCOMPILEDSIM_H
+#define CLASSCOMPILEDSIM_H
+
+#include "ClassNetlist.h"
+#include <string>    // string
+#include <vector>    // vector
+#include <stdint.h>  // uint64_t
+
+/** The function in a compiled simulator; see CompiledSim::simulate(). */
+typedef void (*compiledSimFunc)(const uint64_t* piZero, const uint64_t* piOne, uint64_t* zero, uint64_t* one, int numWords);
+
+class CompiledSim{
+
+ private:
+	void* library;               // handle from dlopen(), or NULL
+	compiledSimFunc function;    // the simulator in library, or NULL
+	uint64_t hash;               // hash of the netlist structure
+
+	bool build(const Netlist* nl, const vector<string>& compiler, const string& base, const string& libName) const;
+	bool writeSource(const Netlist* nl, const string& base, vector<string>& sources) const;
+
+ public:
+	CompiledSim(const Netlist* nl, const string& cacheDir = "");
+	~CompiledSim();
+
+	bool isLoaded() const { return function != NULL; }
+	uint64_t getHash() const { return hash; }
+
+	/** \brief Simulates the fault-free circuit with the compiled code; see the class description. */
+	void simulate(const uint64_t* piZero, const uint64_t* piOne, uint64_t* zero, uint64_t* one, int numWords) const {
+		function(piZero, piOne, zero, one, numWords);
+	}
+
+	static uint64_t hashNetlist(const Netlist* nl);
+};
+
+#endif
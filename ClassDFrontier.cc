@@ -0,0 +1,128 @@
+/** \class DFrontier
+ * \brief The D-frontier of a circuit, maintained incrementally as gate values change.
+ *
+ * A gate is on the D-frontier if its output value is X and at least one of its inputs is
+ * D or D'. Instead of scanning the whole circuit for such gates, the DFrontier keeps, for
+ * each gate, the number of its inputs with value D or D'. Whenever a gate's value changes,
+ * the simulator calls \a update() for it; this adjusts the counts of the gate's outputs and
+ * adds or removes the gate and its outputs from the set, all in time proportional to the
+ * gate's fanout. Since backtracking also changes values through the same calls, gates
+ * leave the set again when PODEM undoes a decision.
+ *
+ * The values are normally the netlist's own, but a DFrontier can also follow a private value
+ * array, such as a PodemWorker's.
+ *
+ * Membership is indexed: each gate knows its position in the member list, so insert,
+ * remove and \a contains() are O(1). \a get() gives the members in no particular order
+ * (e.g. for a random choice), and \a first() gives the member with the smallest ID, which
+ * is the gate a full scan of the circuit in ID order would find first.
+ */
+
+#include "ClassDFrontier.h"
+#include <algorithm>  // push_heap, pop_heap, make_heap
+#include <functional> // greater
+
+/** \brief Construct an empty D-frontier for a netlist.
+ *  \param nl The circuit's Netlist
+ *  \param gateValues The gate values to follow, indexed by gate ID; NULL for the netlist's own values.
+ */
+DFrontier::DFrontier(Netlist* nl, const char* gateValues) {
+	netlist = nl;
+	values = (gateValues == NULL) ? nl->getValues() : gateValues;
+	position.assign(nl->getNumberGates(), -1);
+	clear();
+}
+
+/** \brief Empty the D-frontier and forget all values; use when every gate has been set to X. */
+void DFrontier::clear() {
+	for (int i=0; i<members.size(); i++)
+		position[members[i]] = -1;
+	members.clear();
+	idHeap.clear();
+	isD.assign(netlist->getNumberGates(), 0);
+	dInputs.assign(netlist->getNumberGates(), 0);
+}
+
+/** \brief Tell the D-frontier that the value of gate \a g (may have) changed.
+ *  \param g A gate ID; its new value is read from the followed values.
+ */
+void DFrontier::update(int g) {
+	char v = values[g];
+	char nowD = ((v == LOGIC_D) || (v == LOGIC_DBAR));
+
+	if (nowD != isD[g]) {
+		isD[g] = nowD;
+		for (int k=netlist->fanoutBegin(g); k<netlist->fanoutEnd(g); k++) {
+			int out = netlist->fanoutAt(k);
+			dInputs[out] += nowD ? 1 : -1;
+			refresh(out);
+		}
+	}
+	refresh(g);
+}
+
+/** \brief Recompute the D-frontier from the current values of all gates.
+ *  Use after values were set without calling \a update(), e.g. by a full-circuit simulation.
+ */
+void DFrontier::rebuild() {
+	clear();
+	for (int g=0; g<netlist->getNumberGates(); g++) {
+		char v = values[g];
+		isD[g] = ((v == LOGIC_D) || (v == LOGIC_DBAR));
+		if (isD[g])
+			for (int k=netlist->fanoutBegin(g); k<netlist->fanoutEnd(g); k++)
+				dInputs[netlist->fanoutAt(k)]++;
+	}
+	for (int g=0; g<netlist->getNumberGates(); g++)
+		refresh(g);
+}
+
+/** \brief Get the member of the D-frontier with the smallest gate ID.
+ *  \return The gate ID, or -1 if the D-frontier is empty.
+ */
+int DFrontier::first() {
+	// Gates removed since they were pushed are dropped from the heap lazily, here.
+	while (!idHeap.empty() && !contains(idHeap[0])) {
+		pop_heap(idHeap.begin(), idHeap.end(), greater<int>());
+		idHeap.pop_back();
+	}
+	return idHeap.empty() ? -1 : idHeap[0];
+}
+
+/** \brief Private function: add or remove gate \a g so that its membership matches its current value and inputs. */
+void DFrontier::refresh(int g) {
+	if ((values[g] == LOGIC_X) && (dInputs[g] > 0))
+		insert(g);
+	else
+		remove(g);
+}
+
+/** \brief Private function: add gate \a g, if it is not a member already. */
+void DFrontier::insert(int g) {
+	if (position[g] >= 0)
+		return;
+	position[g] = members.size();
+	members.push_back(g);
+
+	if (idHeap.size() > 2*members.size() + 64) {
+		// mostly stale entries: start over from the current members
+		idHeap = members;
+		make_heap(idHeap.begin(), idHeap.end(), greater<int>());
+	}
+	else {
+		idHeap.push_back(g);
+		push_heap(idHeap.begin(), idHeap.end(), greater<int>());
+	}
+}
+
+/** \brief Private function: remove gate \a g, if it is a member, by moving the last member into its place. */
+void DFrontier::remove(int g) {
+	int p = position[g];
+	if (p < 0)
+		return;
+	int last = members.back();
+	members[p] = last;
+	position[last] = p;
+	members.pop_back();
+	position[g] = -1;
+}
@@ -0,0 +1,37 @@
+#ifndef CLASSDFRONTIER_H
+#define CLASSDFRONTIER_H
+
+#include "ClassNetlist.h"
+#include <vector>    // vector
+
+class DFrontier{
+
+ private:
+	Netlist* netlist;
+	const char* values;      // the gate values the D-frontier is computed from
+
+	vector<char> isD;        // 1 if the gate's value was D or D' when last updated
+	vector<int> dInputs;     // number of inputs of each gate whose value is D or D'
+
+	vector<int> members;     // gate IDs on the D-frontier, in no particular order
+	vector<int> position;    // index of each gate in members, or -1 if not on the D-frontier
+	vector<int> idHeap;      // min-heap of IDs added to members; may hold stale entries (see first())
+
+	void insert(int g);
+	void remove(int g);
+	void refresh(int g);
+
+ public:
+	DFrontier(Netlist* nl, const char* gateValues = NULL);
+
+	void clear();
+	void update(int g);
+	void rebuild();
+
+	int size() const { return members.size(); }
+	int get(int i) const { return members[i]; }
+	bool contains(int g) const { return position[g] >= 0; }
+	int first();
+};
+
+#endif
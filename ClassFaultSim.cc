@@ -0,0 +1,213 @@
+/** \class FaultSim
+ * \brief A parallel-pattern, single-fault-propagation (PPSFP) stuck-at fault simulator.
+ *
+ * The FaultSim keeps a list of faults (added with \a addFault()) and simulates sets of
+ * tests against all of them:
+ * - The tests are loaded into a PatternSim in batches (PATTERNS_PER_BLOCK by default), and the
+ *   fault-free circuit is simulated once for the whole batch.
+ * - Each fault is then injected on its own, and only the gates in its fanout cone whose value
+ *   actually changes are re-evaluated, in level order. Propagation stops as soon as the faulty
+ *   values have merged back into the fault-free ones.
+ * - A fault is detected by pattern \a i if the fault-free and faulty values differ, and neither
+ *   is X, at some PO in pattern \a i. Detected faults are dropped: later calls to \a simulate()
+ *   skip them.
+ *
+ * For every fault, \a getFirstDetection() gives the index of the first pattern (counting all
+ * patterns passed to \a simulate() so far) that detected it.
+ * \a getDetectedFaults() instead gives every fault each test detects, e.g. for compacting a test set.
+ *
+ * Like the PatternSim, the FaultSim has its own value arrays and never changes the values of
+ * the Gates or the Netlist.
+ */
+
+#include "ClassFaultSim.h"
+#include <string.h>  // memcpy, memcmp
+
+/** \brief Construct a new fault simulator for a netlist, with no faults.
+ *  \param nl The circuit's Netlist (see Circuit::getNetlist())
+ *  \param patterns The number of tests simulated in each batch. Use a small number (e.g.
+ *  PATTERNS_PER_WORD) if \a simulate() will be called with only a few tests at a time.
+ */
+FaultSim::FaultSim(Netlist* nl, int patterns) : goodSim(nl, patterns), events(nl) {
+	netlist = nl;
+	numWords = goodSim.getNumberWords();
+	numDetected = 0;
+	numPatterns = 0;
+
+	int n = nl->getNumberGates();
+	zero.assign(n * numWords, 0);
+	one.assign(n * numWords, 0);
+	newZero.assign(numWords, 0);
+	newOne.assign(numWords, 0);
+	detected.assign(numWords, 0);
+
+	isPO.assign(n, 0);
+	const vector<int>& po = nl->getPOs();
+	for (int i=0; i<po.size(); i++)
+		isPO[po[i]] = 1;
+}
+
+/** \brief Add a fault to simulate.
+ *  \param g The ID of the gate whose output is faulty
+ *  \param type FAULT_SA0 or FAULT_SA1
+ *  \return The index of the fault, used in the other functions.
+ */
+int FaultSim::addFault(int g, char type) {
+	assert((type == FAULT_SA0) || (type == FAULT_SA1));
+	faultGate.push_back(g);
+	faultType.push_back(type);
+	firstDetection.push_back(NOT_DETECTED);
+	dropped.push_back(0);
+	return faultGate.size() - 1;
+}
+
+/** \brief Stop simulating a fault, e.g. because it is known to be detected some other way.
+ *  \param f The index of the fault (from \a addFault())
+ *  The fault's first detection is not changed.
+ */
+void FaultSim::dropFault(int f) {
+	dropped[f] = 1;
+}
+
+/** \brief Fault-simulates a set of tests, in order, against all faults not yet detected or dropped.
+ *  \param tests The tests; each one gives one value per PI, in Circuit::getPIGates() order
+ *  (LOGIC_D is treated as 1, LOGIC_DBAR as 0, and anything else as X).
+ *  \param newlyDetected If not NULL, the index of each fault detected by these tests is appended to it.
+ *  \return The number of faults detected by these tests.
+ */
+int FaultSim::simulate(const vector<vector<char> >& tests, vector<int>* newlyDetected) {
+	int detectedBefore = numDetected;
+
+	int batch = goodSim.getNumberPatterns();
+	for (int first = 0; first < tests.size(); first += batch) {
+		goodSim.clearPatterns();
+		for (int i = first; (i < tests.size()) && (i < first + batch); i++)
+			goodSim.setPattern(i - first, tests[i]);
+		goodSim.simulateGood();
+
+		for (int g=0; g<netlist->getNumberGates(); g++) {
+			memcpy(&zero[g*numWords], goodSim.getGoodZero(g), numWords * sizeof(patternWord));
+			memcpy(&one[g*numWords], goodSim.getGoodOne(g), numWords * sizeof(patternWord));
+		}
+
+		for (int f=0; f<faultGate.size(); f++) {
+			if (dropped[f])
+				continue;
+
+			if (propagate(faultGate[f], faultType[f])) {
+				int w = 0;
+				while (detected[w] == 0)
+					w++;
+				firstDetection[f] = numPatterns + w*PATTERNS_PER_WORD + __builtin_ctzll(detected[w]);
+				dropped[f] = 1;
+				numDetected++;
+				if (newlyDetected != NULL)
+					newlyDetected->push_back(f);
+			}
+		}
+
+		numPatterns += ((tests.size() - first < batch) ? tests.size() - first : batch);
+	}
+
+	return numDetected - detectedBefore;
+}
+
+/** \brief Finds every fault each test detects, without fault dropping.
+ *  \param tests The tests, as for \a simulate()
+ *  \param detectedFaults Set to one list per test: the index of each fault the test detects.
+ *  Faults that are detected or dropped already are not simulated.
+ *  Unlike \a simulate(), this does not change any fault's first detection or dropped state,
+ *  nor the number of patterns simulated.
+ */
+void FaultSim::getDetectedFaults(const vector<vector<char> >& tests, vector<vector<int> >& detectedFaults) {
+	detectedFaults.assign(tests.size(), vector<int>());
+
+	int batch = goodSim.getNumberPatterns();
+	for (int first = 0; first < tests.size(); first += batch) {
+		goodSim.clearPatterns();
+		for (int i = first; (i < tests.size()) && (i < first + batch); i++)
+			goodSim.setPattern(i - first, tests[i]);
+		goodSim.simulateGood();
+
+		for (int g=0; g<netlist->getNumberGates(); g++) {
+			memcpy(&zero[g*numWords], goodSim.getGoodZero(g), numWords * sizeof(patternWord));
+			memcpy(&one[g*numWords], goodSim.getGoodOne(g), numWords * sizeof(patternWord));
+		}
+
+		for (int f=0; f<faultGate.size(); f++) {
+			if (dropped[f] || !propagate(faultGate[f], faultType[f]))
+				continue;
+			for (int w=0; w<numWords; w++)
+				for (patternWord bits = detected[w]; bits != 0; bits &= bits - 1)
+					detectedFaults[first + w*PATTERNS_PER_WORD + __builtin_ctzll(bits)].push_back(f);
+		}
+	}
+}
+
+/** \brief Private function that injects one fault and propagates it through its fanout cone.
+ *  \param g The ID of the faulty gate
+ *  \param type FAULT_SA0 or FAULT_SA1
+ *  \return True if any loaded pattern detects the fault; the detecting patterns are in \a detected.
+ *  \note The faulty values (zero, one) must equal the fault-free values on entry; they are
+ *  restored before returning.
+ */
+bool FaultSim::propagate(int g, char type) {
+	const patternWord* loaded = goodSim.getLoadedPatterns();
+	bool activated = false;
+	for (int w=0; w<numWords; w++) {
+		newZero[w] = (type == FAULT_SA0) ? loaded[w] : 0;
+		newOne[w] = (type == FAULT_SA1) ? loaded[w] : 0;
+		activated = activated || (newZero[w] != zero[g*numWords + w]) || (newOne[w] != one[g*numWords + w]);
+	}
+	// the fault is not activated by any pattern
+	if (!activated)
+		return false;
+
+	detected.assign(numWords, 0);
+	valueChanged(g);
+
+	// The gates come out in level order, so each one's inputs have their final faulty values.
+	int gate;
+	while ((gate = events.pop()) >= 0) {
+		goodSim.evaluateGate(gate, &zero[0], &one[0], &newZero[0], &newOne[0]);
+		if ((memcmp(&newZero[0], &zero[gate*numWords], numWords * sizeof(patternWord)) == 0) &&
+		    (memcmp(&newOne[0], &one[gate*numWords], numWords * sizeof(patternWord)) == 0))
+			continue;    // the fault effect does not pass through this gate
+
+		valueChanged(gate);
+	}
+
+	// restore the fault-free values
+	for (int i=0; i<changedGates.size(); i++) {
+		int gate = changedGates[i];
+		memcpy(&zero[gate*numWords], goodSim.getGoodZero(gate), numWords * sizeof(patternWord));
+		memcpy(&one[gate*numWords], goodSim.getGoodOne(gate), numWords * sizeof(patternWord));
+	}
+	changedGates.clear();
+
+	for (int w=0; w<numWords; w++)
+		if (detected[w] != 0)
+			return true;
+	return false;
+}
+
+/** \brief Private function called when the faulty value of a gate differs from its fault-free value.
+ *  \param g The gate ID; its new faulty value is in newZero and newOne.
+ *  Stores the new value, adds the patterns in which \a g drives a PO with a different, known
+ *  value to \a detected, and schedules the outputs of \a g for evaluation.
+ */
+void FaultSim::valueChanged(int g) {
+	memcpy(&zero[g*numWords], &newZero[0], numWords * sizeof(patternWord));
+	memcpy(&one[g*numWords], &newOne[0], numWords * sizeof(patternWord));
+	changedGates.push_back(g);
+
+	if (isPO[g]) {
+		const patternWord* goodZero = goodSim.getGoodZero(g);
+		const patternWord* goodOne = goodSim.getGoodOne(g);
+		for (int w=0; w<numWords; w++)
+			detected[w] |= (goodZero[w] & newOne[w]) | (goodOne[w] & newZero[w]);
+	}
+
+	for (int k=netlist->fanoutBegin(g); k<netlist->fanoutEnd(g); k++)
+		events.push(netlist->fanoutAt(k));
+}
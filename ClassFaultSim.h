@@ -0,0 +1,54 @@
+#ifndef CLASSFAULTSIM_H
+#define CLASSFAULTSIM_H
+
+#include "ClassPatternSim.h"
+#include "ClassLevelQueue.h"
+#include <vector>    // vector
+
+// Value of FaultSim::getFirstDetection() for a fault no pattern has detected yet
+#define NOT_DETECTED -1
+
+class FaultSim{
+
+ private:
+	Netlist* netlist;
+	PatternSim goodSim;               // simulates the fault-free circuit
+	int numWords;                     // words per gate (see PatternSim)
+
+	vector<int> faultGate;            // gate ID of each fault site
+	vector<char> faultType;           // FAULT_SA0 or FAULT_SA1, per fault
+	vector<int> firstDetection;       // first pattern detecting each fault, or NOT_DETECTED
+	vector<char> dropped;             // 1 if the fault is no longer simulated
+	int numDetected;                  // number of faults with a firstDetection
+	int numPatterns;                  // number of patterns simulated so far
+
+	// Values of the faulty circuit, numWords per gate. Outside of propagate() these always
+	// equal the fault-free values; propagate() changes only the gates listed in changedGates.
+	vector<patternWord> zero, one;
+	vector<int> changedGates;
+	vector<patternWord> newZero, newOne; // one block each: the value of the gate being evaluated
+	vector<patternWord> detected;        // one block: the patterns detecting the current fault
+
+	LevelQueue events;                // gates waiting to be evaluated
+	vector<char> isPO;                // 1 if the gate drives a PO
+
+	bool propagate(int g, char type);
+	void valueChanged(int g);
+
+ public:
+	FaultSim(Netlist* nl, int patterns = PATTERNS_PER_BLOCK);
+
+	int addFault(int g, char type);
+	void dropFault(int f);
+
+	int simulate(const vector<vector<char> >& tests, vector<int>* newlyDetected = NULL);
+	void getDetectedFaults(const vector<vector<char> >& tests, vector<vector<int> >& detectedFaults);
+
+	int getNumberFaults() const { return faultGate.size(); }
+	int getNumberDetected() const { return numDetected; }
+	int getNumberPatterns() const { return numPatterns; }
+	int getFirstDetection(int f) const { return firstDetection[f]; }
+	bool isDetected(int f) const { return firstDetection[f] != NOT_DETECTED; }
+};
+
+#endif
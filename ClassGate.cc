@@ -16,7 +16,7 @@
  *   whose outputs are the inputs to this gate. (If this gate is a PI, then it has no predecessors.)
  *   The successors are the gates who take in the input of this gate. (If this gate drives a PO, then
  *   it has no successors. You can access these vectors by running the \a get_gateInputs() and
- *   \a get_gateOutputs() functions.
+ *   \a get_gateOutputs() functions, which return a GateView of them (no copy is made).
  * 
  * - A logical value that indicates the output value of the gate in the current simulation. Currently,
  *   legal values are, 0, 1, D, B ("not D"), X, and "unset." The "unset" value indicates that the 
@@ -37,30 +37,39 @@
 #include "ClassGate.h"
 
 /** \brief Constructor for a new Gate.
- *  \param name a string providing the output name for the gate
+ *  \param name the output name for the gate. This must point to an interned name (see NameTable) that outlives the Gate.
  *  \param ID a unique ID number for the gate (primarily used while parsing the input source file)
  *  \param gt the type of gate, using the GATE_* marcos defined in ClassGate.h
  */
-Gate::Gate(string name, int ID, int gt) {
+Gate::Gate(const string* name, int ID, int gt) {
 	outputName = name; 
 	gateID = ID; 
 	gateType = gt; 
-	gateValue = LOGIC_UNSET;
+	gateValue = &ownValue;
+	faultType = &ownFault;
+	scoap = &ownSCOAP;
+	*gateValue = LOGIC_UNSET;
+	*faultType = NOFAULT;
 	depth = -1;
-        cc0 = -1;
-        cc1 = -1;
-        co = -1;
+        scoap->cc0 = -1;
+        scoap->cc1 = -1;
+        scoap->co = -1;
 }
 	
+/** \brief Get the unique ID of this gate.
+ *  \return The gate's ID. This is also its index in the Circuit (see Circuit::getGateByID()).
+ */
+int Gate::get_gateID() { return gateID; }
+
 /** \brief Get the gate type for this gate.
  *  \return The gate type, using the GATE_* macros defined in ClassGate.h
  */
 char Gate::get_gateType() { return gateType; }
 
 /** \brief Get the gate's output pointers.
- *  \return A vector of pointers to the gates that this gate's output connects to.
+ *  \return A view of the pointers to the gates that this gate's output connects to. (No copy is made.)
  */
-vector<Gate*> Gate::get_gateOutputs() { return gateOutputs; }
+GateView Gate::get_gateOutputs() { return GateView(gateOutputs); }
 
 /** \brief Add a pointer to Gate \a x as an output destination of this gate.
  *  \param x A pointer to a Gate that takes this Gate's output as input.
@@ -87,9 +96,9 @@ void Gate::replace_gateOutput(Gate* oldGate, Gate* newGate) {
 }
 
 /** \brief Get the gate's input pointers.
- *  \return A vector of pointers to the gates whose outputs connect to this gate's inputs.
+ *  \return A view of the pointers to the gates whose outputs connect to this gate's inputs. (No copy is made.)
  */
-vector<Gate*> Gate::get_gateInputs() { return gateInputs; }
+GateView Gate::get_gateInputs() { return GateView(gateInputs); }
 
 /** \brief Add a pointer to Gate \a x as an input source of this gate.
  *  \param x A pointer to a Gate whose output is an input to this gate.
@@ -119,17 +128,17 @@ void Gate::replace_gateInput(Gate* oldGate, Gate* newGate) {
 /** \brief Get the name of output of this gate.
  * \return A string containing the name of the output of this gate.
  */
-string Gate::get_outputName() { return outputName; }			
+const string& Gate::get_outputName() { return *outputName; }			
 
 
 /** \brief Print information about this gate.
  */			
 void Gate::printGateInfo() {
-	cout << "Gate " << gateID << ": " << outputName;
+	cout << "Gate " << gateID << ": " << *outputName;
 	
-	if (faultType == FAULT_SA0)
+	if (*faultType == FAULT_SA0)
 		cout << "/0";
-	if (faultType == FAULT_SA1)
+	if (*faultType == FAULT_SA1)
 		cout << "/1";
 
 	cout << " = " << gateTypeName() << "(";
@@ -143,8 +152,8 @@ void Gate::printGateInfo() {
 	}
 
 	cout << ")";
-	if (gateValue != LOGIC_UNSET)
-		cout << " = " << printLogicVal(gateValue) << ";";
+	if (*gateValue != LOGIC_UNSET)
+		cout << " = " << printLogicVal(*gateValue) << ";";
 	else
 		cout << ";";
 		
@@ -204,7 +213,7 @@ void Gate::setValue(int val) {
 			 assert(false);
 		}
 	} 
-	gateValue = val; 
+	*gateValue = val; 
 }
 
 /** \brief Gets the value of this gate's output.
@@ -212,7 +221,7 @@ void Gate::setValue(int val) {
  *  \return The logic value (based on the LOGIC_* marcos in ClassGate.h).
  */
 char Gate::getValue() { 
-	return gateValue;
+	return *gateValue;
 }
 
 /** \brief Gets the value of this's gate's output as a string (intended for printing).
@@ -220,23 +229,23 @@ char Gate::getValue() {
  *  \return The logical value of this gate as a string.
  */
 string Gate::printValue() {
-	return printLogicVal(gateValue);
+	return printLogicVal(*gateValue);
 }
 
 
 /** \brief Stores the name of one of this gate's input signals.
- *  \param n The name of one of this gate's inputs.
+ *  \param sym The name of one of this gate's inputs, interned in the Circuit's NameTable (see Circuit::internName()).
  *  \note Normally, this code should only need to be run by the parser, and its results should only need to be used by the setupCircuit() function of Circut. You should never need to touch this.
  */
-void Gate::set_gateInputName(string n) {
-	inputName.push_back(n);
+void Gate::set_gateInputSymbol(int sym) {
+	inputSymbols.push_back(sym);
 }
 
-/** \brief Gets the pre-stored names of this gate's input signals. 
+/** \brief Gets the pre-stored names of this gate's input signals, as symbol IDs in the Circuit's NameTable.
  *  Normally, this code should only need to be run by the setupCircuit() function of Circut.
  */
-vector<string> Gate::get_gateInputNames() {
-	return inputName;
+const vector<int>& Gate::get_gateInputSymbols() {
+	return inputSymbols;
 }
 
 /** \brief Finds which of this gate's inputs is connected to the output of Gate \a g.
@@ -257,6 +266,23 @@ int Gate::getGateInputNumber(Gate *g) {
 	return -1;
 }
 
+/** \brief Moves this gate's value, fault type and SCOAP numbers to external storage.
+ *  \param value Where to keep the gate's logic value from now on
+ *  \param fault Where to keep the gate's fault type from now on
+ *  \param sc Where to keep the gate's SCOAP numbers from now on
+ *  The current values are copied to the new locations first.
+ *  \note This is run by Netlist::build(), so the Gate and the Netlist share one copy of each value.
+ *  You should never need to run this.
+ */
+void Gate::bindStorage(char* value, char* fault, scoapStruct* sc) {
+	*value = *gateValue;
+	*fault = *faultType;
+	*sc = *scoap;
+	gateValue = value;
+	faultType = fault;
+	scoap = sc;
+}
+
 /** \brief Set this gate's depth. 
  *  \param d Depth
  */
@@ -277,43 +303,37 @@ int Gate::getDepth() {
  */
 void Gate::set_faultType(char f) {
 	assert((f == NOFAULT) || (f == FAULT_SA0) || (f == FAULT_SA1));
-	faultType = f;
+	*faultType = f;
 }
 
 /** \brief Gets the fault type on the output of this Gate.
  *  \return a char equal to NOFAULT, FAULT_SA0, or FAULT_SA1.
  */
 char Gate::get_faultType() {
-	return faultType;
+	return *faultType;
 }
 
 
 void Gate::set_CC0(int val){
-  cc0 = val;
+  scoap->cc0 = val;
 }
 
 int Gate::get_CC0(){
-  return cc0;
+  return scoap->cc0;
 }
 
 void Gate::set_CC1(int val){
-  cc1 = val;
+  scoap->cc1 = val;
 }
 
 int Gate::get_CC1(){
-  return cc1;
+  return scoap->cc1;
 }
 
 void Gate::set_CO(int val){
-  co = val;
+  scoap->co = val;
 }
 
 int Gate::get_CO(){
-  return co;
+  return scoap->co;
 }
-
-
-
-
-
-
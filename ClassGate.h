@@ -38,6 +38,38 @@ using namespace std;
 #define CC_UNSET -1
 #define CC_IN 1
 #define CO_OUT 0 
+// SCOAP numbers saturate here (see Netlist::computeSCOAP()); small enough that adding a few does not overflow an int
+#define SCOAP_MAX 0x1fffffff
+
+class Gate;
+
+/** \brief A read-only view of a list of Gate pointers.
+ *  A GateView does not own or copy the pointers; it refers to a list stored elsewhere
+ *  (for example, a Gate's input list), so it is only valid as long as that list is not
+ *  changed. It supports size(), [], and range-based for loops like a vector.
+ */
+class GateView {
+ private:
+	Gate* const* first;
+	Gate* const* last;
+
+ public:
+	GateView() : first(NULL), last(NULL) {}
+	GateView(const vector<Gate*>& v) : first(v.data()), last(v.data() + v.size()) {}
+
+	Gate* const* begin() const { return first; }
+	Gate* const* end() const { return last; }
+	int size() const { return last - first; }
+	bool empty() const { return first == last; }
+	Gate* operator[](int i) const { return first[i]; }
+};
+
+/** \brief The SCOAP testability numbers of one gate output. */
+struct scoapStruct {
+	int cc0; // Combinational 0-controllability
+	int cc1; // Combinational 1-controllability
+	int co;  // Combinational observability
+};
 
 class Gate{
 
@@ -46,39 +78,42 @@ class Gate{
 	char gateType;             // Gate type (macros above: GATE_NAND, etc.)
 	vector<Gate*> gateInputs;  // Stores the pointers to all the gates that this gate's inputs connect to.
 	vector<Gate*> gateOutputs; // Stores the pointers to all the gates that this gate's output connects to.
-	string outputName;         // The name of the output of this gate
+	const string* outputName;  // The name of the output of this gate (interned in the Circuit's NameTable)
 
-	char gateValue;            // The logic value of this gate's output (using macros above: LOGIC_ZERO, etc.
+	char* gateValue;           // The logic value of this gate's output (using macros above: LOGIC_ZERO, etc.)
 
 	string printLogicVal(int val);
-	vector<string> inputName;  // A list of the names of the inputs to this gate.
+	vector<int> inputSymbols;  // The names of the inputs to this gate, as symbol IDs in the Circuit's NameTable.
 
 	int depth;                 // A variable for you to store the depth of this gate: the largest number of gates
                                // of any path between a PI and this gate's output. By definition a "PI" gate has 
                                // depth 0.
 
-	char faultType;            // Type of fault on this gate's output (NOFAULT, FAULT_SA0, FAULT_SA1)
+	char* faultType;           // Type of fault on this gate's output (NOFAULT, FAULT_SA0, FAULT_SA1)
         
-        int cc0;                   // Variable to store CC0(Controlability 0) for SCOAP Matrix
+        scoapStruct* scoap;        // SCOAP Matrix values (CC0, CC1 and CO) for this gate's output
 
-        int cc1;                   // Variable to store CC1(Controlability 1) for SCOAP Matrix
-
-        int co;                   // Variable to store CO(Observability) for SCOAP Matrix
+	// Storage for the three values above until the Circuit's Netlist is built. After that,
+	// gateValue, faultType and scoap point into the Netlist's arrays (see bindStorage()).
+	char ownValue;
+	char ownFault;
+	scoapStruct ownSCOAP;
 
  public:
-	Gate(string name, int ID, int gt);
+	Gate(const string* name, int ID, int gt);
 	
+	int get_gateID();
 	char get_gateType();
 
-	vector<Gate*> get_gateOutputs();
+	GateView get_gateOutputs();
 	void set_gateOutput(Gate* x);
 	void replace_gateOutput(Gate* oldGate, Gate* newGate);
  
-	vector<Gate*> get_gateInputs();
+	GateView get_gateInputs();
 	void set_gateInput(Gate* x);
 	void replace_gateInput(Gate* oldGate, Gate* newGate);
 	
-	string get_outputName();
+	const string& get_outputName();
 
 	void printGateInfo();
 	string gateTypeName();
@@ -87,11 +122,13 @@ class Gate{
 	char getValue();
 	string printValue();
 
-	void set_gateInputName(string n);
-	vector<string> get_gateInputNames();
+	void set_gateInputSymbol(int sym);
+	const vector<int>& get_gateInputSymbols();
 
 	int getGateInputNumber(Gate *g);
 
+	void bindStorage(char* value, char* fault, scoapStruct* sc);
+
 	int getDepth();
 	void setDepth(int d);
 
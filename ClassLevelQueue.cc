@@ -0,0 +1,31 @@
+/** \class LevelQueue
+ * \brief A queue of gates to evaluate, returned in level order, each gate at most once.
+ *
+ * Event-driven simulation schedules the outputs of every gate whose value changes. With a
+ * plain FIFO, a gate reached over several reconvergent paths is evaluated once per path, and
+ * in between it may take on transient values. The LevelQueue instead returns the queued gates
+ * sorted by level (see Netlist::getLevel(), which is also each Gate's depth). Since a gate's
+ * inputs all have lower levels, by the time a gate is returned all of its inputs have their
+ * final values, so it is evaluated only once per wave of events. A gate that is already queued
+ * is not queued again.
+ *
+ * The queue is a bit set over the positions of the gates in the netlist's level order:
+ * pushing a gate sets its bit, and popping finds the lowest set bit. Gates on the same level
+ * come out in ID order. No memory is allocated after construction.
+ */
+
+#include "ClassLevelQueue.h"
+
+/** \brief Construct an empty queue for a netlist.
+ *  \param nl The circuit's Netlist
+ */
+LevelQueue::LevelQueue(Netlist* nl) {
+	order = &nl->getLevelOrder();
+	rank.assign(nl->getNumberGates(), 0);
+	for (int r=0; r<order->size(); r++)
+		rank[(*order)[r]] = r;
+
+	queued.assign(nl->getNumberGates() / 64 + 1, 0);
+	numQueued = 0;
+	currentWord = 0;
+}
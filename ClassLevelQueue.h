@@ -0,0 +1,64 @@
+#ifndef CLASSLEVELQUEUE_H
+#define CLASSLEVELQUEUE_H
+
+#include "ClassNetlist.h"
+#include <vector>    // vector
+#include <stdint.h>  // uint64_t
+
+class LevelQueue{
+
+ private:
+	const vector<int>* order;     // the netlist's level order (Netlist::getLevelOrder())
+	vector<int> rank;             // position of each gate in the level order
+
+	// Bit r is set if the gate at position r of the level order is queued.
+	vector<uint64_t> queued;
+	int numQueued;                // number of gates queued
+	int currentWord;              // no bits are set in the words before this one
+
+ public:
+	LevelQueue(Netlist* nl);
+
+	void push(int g);
+	int pop();
+	bool empty() const { return numQueued == 0; }
+};
+
+// push() and pop() are called for every event in the simulators' inner loops, so they are
+// defined here to be inlined.
+
+/** \brief Add a gate to the queue, unless it is queued already.
+ *  \param g A gate ID. While the queue is being emptied, \a g must not come before the last
+ *  gate returned by \a pop() in level order (true for the outputs of that gate).
+ */
+inline void LevelQueue::push(int g) {
+	int r = rank[g];
+	uint64_t bit = ((uint64_t)1) << (r & 63);
+	if (queued[r >> 6] & bit)
+		return;
+
+	if (numQueued == 0)
+		currentWord = r >> 6;
+	assert((r >> 6) >= currentWord);
+
+	queued[r >> 6] |= bit;
+	numQueued++;
+}
+
+/** \brief Remove and return the first queued gate in level order.
+ *  \return A gate ID, or -1 if the queue is empty.
+ */
+inline int LevelQueue::pop() {
+	if (numQueued == 0)
+		return -1;
+
+	while (queued[currentWord] == 0)
+		currentWord++;
+
+	int r = (currentWord << 6) + __builtin_ctzll(queued[currentWord]);
+	queued[currentWord] &= queued[currentWord] - 1;    // clear the lowest set bit
+	numQueued--;
+	return (*order)[r];
+}
+
+#endif
@@ -0,0 +1,64 @@
+/** \class Logic
+ * \brief Truth tables for gate evaluation and fault injection in the 5-valued logic (0, 1, D, D', X).
+ *
+ * Each of 0, 1, D and D' is a pair of bits: the value in the good circuit and the value in the
+ * faulty circuit (D is 1/0, D' is 0/1), and X is X/X. An n-input gate is evaluated by folding
+ * its inputs one at a time into a state that keeps the good and faulty bits separately, each
+ * three-valued (0, 1 or X):
+ *
+ *     int s = Logic::start(t);
+ *     for (each input value v)
+ *         s = Logic::fold(t, s, v);
+ *     char out = Logic::output(t, s);
+ *
+ * Keeping the bits separate (9 states) instead of folding 5-valued values makes the result
+ * exact for any number of inputs: AND(D, X, D') is 0, since both its good and faulty bits
+ * are 0, where folding AND(D, X) = X first would lose that.
+ *
+ * The tables are generated at compile time by the constexpr functions in ClassLogic.h, so
+ * each gate evaluation is one table lookup per input and one for the output, with no branches
+ * on the gate type or the values. BUFF and FANOUT fold like a one-input AND, and NOT like a
+ * one-input NAND. \a injectFault() accounts for a stuck-at fault on a gate's output.
+ *
+ * test/test_logic.cc ("make test") compares the tables exhaustively against the if-based
+ * evaluation they replace.
+ */
+
+#include "ClassLogic.h"
+
+#define LOGIC_FOLD_STATE(t, s) { Logic::foldEntry(t, s, LOGIC_ZERO), Logic::foldEntry(t, s, LOGIC_ONE), \
+	Logic::foldEntry(t, s, LOGIC_D), Logic::foldEntry(t, s, LOGIC_DBAR), Logic::foldEntry(t, s, LOGIC_X) }
+#define LOGIC_FOLD_GATE(t) { LOGIC_FOLD_STATE(t, 0), LOGIC_FOLD_STATE(t, 1), LOGIC_FOLD_STATE(t, 2), \
+	LOGIC_FOLD_STATE(t, 3), LOGIC_FOLD_STATE(t, 4), LOGIC_FOLD_STATE(t, 5), LOGIC_FOLD_STATE(t, 6), \
+	LOGIC_FOLD_STATE(t, 7), LOGIC_FOLD_STATE(t, 8) }
+#define LOGIC_OUTPUT_GATE(t) { Logic::outputEntry(t, 0), Logic::outputEntry(t, 1), Logic::outputEntry(t, 2), \
+	Logic::outputEntry(t, 3), Logic::outputEntry(t, 4), Logic::outputEntry(t, 5), Logic::outputEntry(t, 6), \
+	Logic::outputEntry(t, 7), Logic::outputEntry(t, 8) }
+#define LOGIC_FAULT(f) { LOGIC_UNSET, Logic::faultEntry(f, LOGIC_ZERO), Logic::faultEntry(f, LOGIC_ONE), \
+	Logic::faultEntry(f, LOGIC_D), Logic::faultEntry(f, LOGIC_DBAR), Logic::faultEntry(f, LOGIC_X) }
+
+/** Next state for each gate type, state and input value. */
+const char Logic::foldTable[LOGIC_GATE_TYPES][LOGIC_STATES][5] = {
+	LOGIC_FOLD_GATE(0), LOGIC_FOLD_GATE(1), LOGIC_FOLD_GATE(2), LOGIC_FOLD_GATE(3),
+	LOGIC_FOLD_GATE(4), LOGIC_FOLD_GATE(5), LOGIC_FOLD_GATE(6), LOGIC_FOLD_GATE(7),
+	LOGIC_FOLD_GATE(8), LOGIC_FOLD_GATE(9), LOGIC_FOLD_GATE(10)
+};
+
+/** Output value for each gate type and final state. */
+const char Logic::outputTable[LOGIC_GATE_TYPES][LOGIC_STATES] = {
+	LOGIC_OUTPUT_GATE(0), LOGIC_OUTPUT_GATE(1), LOGIC_OUTPUT_GATE(2), LOGIC_OUTPUT_GATE(3),
+	LOGIC_OUTPUT_GATE(4), LOGIC_OUTPUT_GATE(5), LOGIC_OUTPUT_GATE(6), LOGIC_OUTPUT_GATE(7),
+	LOGIC_OUTPUT_GATE(8), LOGIC_OUTPUT_GATE(9), LOGIC_OUTPUT_GATE(10)
+};
+
+/** Initial state for each gate type. */
+const char Logic::startTable[LOGIC_GATE_TYPES] = {
+	Logic::startEntry(0), Logic::startEntry(1), Logic::startEntry(2), Logic::startEntry(3),
+	Logic::startEntry(4), Logic::startEntry(5), Logic::startEntry(6), Logic::startEntry(7),
+	Logic::startEntry(8), Logic::startEntry(9), Logic::startEntry(10)
+};
+
+/** Faulty output value, indexed by fault + 1 and value + 1 (LOGIC_UNSET passes through). */
+const char Logic::faultTable[3][6] = {
+	LOGIC_FAULT(NOFAULT), LOGIC_FAULT(FAULT_SA0), LOGIC_FAULT(FAULT_SA1)
+};
@@ -0,0 +1,88 @@
+#ifndef CLASSLOGIC_H
+#define CLASSLOGIC_H
+
+#include "ClassGate.h"
+
+// A fold state is a pair of three-valued bits, the value in the good circuit and the value in
+// the faulty circuit, each 0, 1 or X (LOGIC_BIT_X). The state number is 3*good + faulty.
+#define LOGIC_BIT_X 2
+#define LOGIC_STATES 9
+#define LOGIC_GATE_TYPES 11    // GATE_NAND ... GATE_FANOUT
+
+class Logic{
+
+ private:
+	// The constexpr functions below generate the tables at compile time.
+
+	// the good or faulty bit of a 5-valued logic value
+	static constexpr int goodBit(int v) {
+		return ((v == LOGIC_ONE) || (v == LOGIC_D)) ? 1 : ((v == LOGIC_X) ? LOGIC_BIT_X : 0);
+	}
+	static constexpr int faultyBit(int v) {
+		return ((v == LOGIC_ONE) || (v == LOGIC_DBAR)) ? 1 : ((v == LOGIC_X) ? LOGIC_BIT_X : 0);
+	}
+
+	// three-valued AND, OR and XOR of two bits
+	static constexpr int andBit(int a, int b) {
+		return ((a == 0) || (b == 0)) ? 0 : (((a == LOGIC_BIT_X) || (b == LOGIC_BIT_X)) ? LOGIC_BIT_X : 1);
+	}
+	static constexpr int orBit(int a, int b) {
+		return ((a == 1) || (b == 1)) ? 1 : (((a == LOGIC_BIT_X) || (b == LOGIC_BIT_X)) ? LOGIC_BIT_X : 0);
+	}
+	static constexpr int xorBit(int a, int b) {
+		return ((a == LOGIC_BIT_X) || (b == LOGIC_BIT_X)) ? LOGIC_BIT_X : (a ^ b);
+	}
+
+	static constexpr bool isOr(int t) { return (t == GATE_OR) || (t == GATE_NOR); }
+	static constexpr bool isXor(int t) { return (t == GATE_XOR) || (t == GATE_XNOR); }
+	static constexpr bool inverts(int t) {
+		return (t == GATE_NAND) || (t == GATE_NOR) || (t == GATE_XNOR) || (t == GATE_NOT);
+	}
+
+	// combines one bit of the state with one bit of a new input
+	static constexpr int foldBit(int t, int s, int v) {
+		return isXor(t) ? xorBit(s, v) : (isOr(t) ? orBit(s, v) : andBit(s, v));
+	}
+
+	// the 5-valued logic value of a pair of bits
+	static constexpr char bitsValue(int good, int faulty) {
+		return ((good == LOGIC_BIT_X) || (faulty == LOGIC_BIT_X)) ? LOGIC_X :
+			((good == faulty) ? (good ? LOGIC_ONE : LOGIC_ZERO) : (good ? LOGIC_D : LOGIC_DBAR));
+	}
+
+	static constexpr int invertBit(int b) { return (b == LOGIC_BIT_X) ? LOGIC_BIT_X : !b; }
+
+ public:
+	/** \brief The state after folding in the input value \a v (LOGIC_ZERO ... LOGIC_X) at state \a s, for gate type \a t. */
+	static constexpr char foldEntry(int t, int s, int v) {
+		return 3*foldBit(t, s/3, goodBit(v)) + foldBit(t, s%3, faultyBit(v));
+	}
+	/** \brief The output of gate type \a t in state \a s, after all inputs are folded in. */
+	static constexpr char outputEntry(int t, int s) {
+		return inverts(t) ? bitsValue(invertBit(s/3), invertBit(s%3)) : bitsValue(s/3, s%3);
+	}
+	/** \brief The state of gate type \a t before any input is folded in: 0 for OR and XOR, 1 otherwise. */
+	static constexpr char startEntry(int t) {
+		return (isOr(t) || isXor(t)) ? 0 : 3*1 + 1;
+	}
+	/** \brief The value seen on a gate output with fault \a f (NOFAULT, FAULT_SA0 or FAULT_SA1) when its fault-free value is \a v. */
+	static constexpr char faultEntry(int f, int v) {
+		return ((f == FAULT_SA0) && (v == LOGIC_ONE)) ? LOGIC_D : (((f == FAULT_SA1) && (v == LOGIC_ZERO)) ? LOGIC_DBAR : v);
+	}
+
+	static const char foldTable[LOGIC_GATE_TYPES][LOGIC_STATES][5];
+	static const char outputTable[LOGIC_GATE_TYPES][LOGIC_STATES];
+	static const char startTable[LOGIC_GATE_TYPES];
+	static const char faultTable[3][6];
+
+	/** \brief The fold state of a gate of type \a t with no inputs yet. */
+	static int start(char t) { return startTable[(unsigned char)t]; }
+	/** \brief Folds input value \a v (LOGIC_ZERO ... LOGIC_X, not LOGIC_UNSET) into state \a s of a gate of type \a t. */
+	static int fold(char t, int s, char v) { return foldTable[(unsigned char)t][s][(unsigned char)v]; }
+	/** \brief The output value of a gate of type \a t whose inputs have been folded into state \a s. */
+	static char output(char t, int s) { return outputTable[(unsigned char)t][s]; }
+	/** \brief The value seen on an output with fault \a f (NOFAULT, FAULT_SA0 or FAULT_SA1) whose fault-free value is \a v (any LOGIC_* value). */
+	static char injectFault(char f, char v) { return faultTable[f+1][v+1]; }
+};
+
+#endif
@@ -0,0 +1,94 @@
+/** \class NameTable
+ * \brief The symbol table that maps signal names in a circuit to gates.
+ *
+ * Every signal name seen while building a Circuit is interned exactly once: the table
+ * hands back a small integer "symbol ID", and the name itself is stored only once
+ * (Gates keep a pointer to the interned copy instead of their own string).
+ *
+ * A symbol may be interned before the gate that drives it has been seen (in a .bench
+ * file a gate's inputs can be declared later in the file), so each symbol also records
+ * which gate, if any, defines it. \a defineGate() refuses to define a name twice, which
+ * is how the Circuit detects duplicate gate names.
+ *
+ * All lookups (name --> symbol, symbol --> name, symbol --> gate) are O(1).
+ */
+
+#include "ClassNameTable.h"
+
+/** \brief Construct a new, empty name table */
+NameTable::NameTable() {}
+
+/** \brief Reserve space for \a n symbols (optional; only avoids rehashing).
+ *  \param n The number of symbols expected
+ */
+void NameTable::reserve(int n) {
+	symbolIndex.reserve(n);
+	symbolNames.reserve(n);
+	symbolGate.reserve(n);
+}
+
+/** \brief Get the symbol ID of \a name, adding it to the table if it is new.
+ *  \param name The signal name
+ *  \return The symbol ID of \a name
+ */
+int NameTable::intern(const string& name) {
+	unordered_map<string, int>::iterator it = symbolIndex.find(name);
+	if (it != symbolIndex.end())
+		return it->second;
+
+	int sym = symbolNames.size();
+	it = symbolIndex.insert(make_pair(name, sym)).first;
+
+	// Keys of an unordered_map never move, so we can keep a pointer to the stored name.
+	symbolNames.push_back(&(it->first));
+	symbolGate.push_back(SYMBOL_UNDEFINED);
+	return sym;
+}
+
+/** \brief Get the symbol ID of \a name without adding it.
+ *  \param name The signal name
+ *  \return The symbol ID of \a name, or SYMBOL_UNDEFINED if it has never been interned
+ */
+int NameTable::lookup(const string& name) const {
+	unordered_map<string, int>::const_iterator it = symbolIndex.find(name);
+	if (it == symbolIndex.end())
+		return SYMBOL_UNDEFINED;
+	return it->second;
+}
+
+/** \brief Get the interned name of symbol \a sym.
+ *  \param sym A symbol ID returned by \a intern()
+ *  \return A reference to the stored name. It stays valid as long as the table does.
+ */
+const string& NameTable::getName(int sym) const {
+	assert((sym >= 0) && (sym < symbolNames.size()));
+	return *symbolNames[sym];
+}
+
+/** \brief Record that gate \a gateID drives the signal \a sym.
+ *  \param sym A symbol ID returned by \a intern()
+ *  \param gateID The ID of the gate whose output has this name
+ *  \return false if \a sym was already defined by another gate (a duplicate name), true otherwise
+ */
+bool NameTable::defineGate(int sym, int gateID) {
+	assert((sym >= 0) && (sym < symbolGate.size()));
+	if (symbolGate[sym] != SYMBOL_UNDEFINED)
+		return false;
+	symbolGate[sym] = gateID;
+	return true;
+}
+
+/** \brief Get the ID of the gate that drives the signal \a sym.
+ *  \param sym A symbol ID, or SYMBOL_UNDEFINED
+ *  \return The gate ID, or SYMBOL_UNDEFINED if no gate has been defined with this name
+ */
+int NameTable::getGateID(int sym) const {
+	if ((sym < 0) || (sym >= symbolGate.size()))
+		return SYMBOL_UNDEFINED;
+	return symbolGate[sym];
+}
+
+/** \brief Get the number of interned symbols.
+ *  \return The number of symbols in the table.
+ */
+int NameTable::size() const { return symbolNames.size(); }
@@ -0,0 +1,34 @@
+#ifndef CLASSNAMETABLE_H
+#define CLASSNAMETABLE_H
+
+#include <string>        // string
+#include <vector>        // vector
+#include <unordered_map> // unordered_map
+#include <assert.h>      // assert
+using namespace std;
+
+// Marco for a symbol or gate that has not been defined
+#define SYMBOL_UNDEFINED -1
+
+class NameTable{
+
+ private:
+	unordered_map<string, int> symbolIndex; // Maps each interned name to its symbol ID.
+	vector<const string*> symbolNames;      // Symbol ID --> the single stored copy of its name (a key of symbolIndex).
+	vector<int> symbolGate;                 // Symbol ID --> ID of the gate whose output has this name (or SYMBOL_UNDEFINED).
+
+ public:
+	NameTable();
+	void reserve(int n);
+
+	int intern(const string& name);
+	int lookup(const string& name) const;
+	const string& getName(int sym) const;
+
+	bool defineGate(int sym, int gateID);
+	int getGateID(int sym) const;
+
+	int size() const;
+};
+
+#endif
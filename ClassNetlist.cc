@@ -0,0 +1,370 @@
+/** \class Netlist
+ * \brief A compact, frozen, levelized copy of a Circuit, for use in simulation and PODEM inner loops.
+ *
+ * A Circuit is built one Gate at a time, and each Gate keeps its connectivity in its own
+ * heap-allocated vectors. That is convenient while parsing, but slow to walk. Once
+ * Circuit::setupCircuit() has finished (including inserting FANOUT gates), it builds a
+ * Netlist, which stores the same circuit as a structure of arrays indexed by gate ID:
+ * - the gate types, output values, fault types and SCOAP numbers, each in one contiguous array
+ * - the inputs and outputs of every gate in compressed sparse row (CSR) form: one array of
+ *   gate IDs, plus an offset array giving where each gate's list starts
+ * - the PI and PO gate IDs, and an order of all gates sorted by level
+ *
+ * \a computeSCOAP() fills in the SCOAP numbers with one pass over that order in each direction.
+ * \a build() also picks an evaluation kernel for each gate, specialized for its type and number
+ * of inputs (up to KERNEL_MAX_INPUTS), so \a evaluate() does not branch on either.
+ *
+ * The value, fault and SCOAP arrays are the storage for the Gate objects too: after
+ * \a build() every Gate is bound to its entries here (see Gate::bindStorage()), so code using
+ * the Gate API and code using the Netlist always see the same values. The structure itself
+ * cannot change after \a build(); the Gate and Circuit API remain as a construction-time view.
+ *
+ * \a load() builds the same netlist from a NetlistCache instead, copying its arrays (including
+ * the levels and the level order) as they are.
+ */
+
+#include "ClassNetlist.h"
+#include "ClassNetlistCache.h"
+#include <algorithm>  // min, swap
+
+/** \brief Construct a new, empty netlist */
+Netlist::Netlist() {
+	numGates = 0;
+	compiledSim = NULL;
+}
+
+/** \brief Build the netlist from the gates of a Circuit.
+ *  \param gates All gates of the circuit. Gate \a i must have ID \a i.
+ *  \param inputGates The PI gates of the circuit
+ *  \param outputGates The gates driving the POs of the circuit
+ *  \note This is run once, by Circuit::setupCircuit(). It binds each Gate's value, fault and
+ *  SCOAP storage to this netlist, so the netlist must live as long as the gates. It also sets
+ *  each Gate's depth to its level.
+ */
+void Netlist::build(vector<Gate*>& gates, vector<Gate*>& inputGates, vector<Gate*>& outputGates) {
+	numGates = gates.size();
+
+	gateType.resize(numGates);
+	gateValue.resize(numGates);
+	faultType.resize(numGates);
+	scoap.resize(numGates);
+	faninStart.assign(numGates+1, 0);
+	fanoutStart.assign(numGates+1, 0);
+
+	for (int i=0; i<numGates; i++) {
+		Gate* g = gates[i];
+		assert(g->get_gateID() == i);
+
+		gateType[i] = g->get_gateType();
+		gateValue[i] = g->getValue();
+		faultType[i] = g->get_faultType();
+		scoap[i].cc0 = g->get_CC0();
+		scoap[i].cc1 = g->get_CC1();
+		scoap[i].co = g->get_CO();
+
+		faninStart[i+1] = faninStart[i] + g->get_gateInputs().size();
+		fanoutStart[i+1] = fanoutStart[i] + g->get_gateOutputs().size();
+	}
+
+	faninList.resize(faninStart[numGates]);
+	fanoutList.resize(fanoutStart[numGates]);
+	for (int i=0; i<numGates; i++) {
+		GateView gi = gates[i]->get_gateInputs();
+		for (int j=0; j<gi.size(); j++)
+			faninList[faninStart[i]+j] = gi[j]->get_gateID();
+
+		GateView go = gates[i]->get_gateOutputs();
+		for (int j=0; j<go.size(); j++)
+			fanoutList[fanoutStart[i]+j] = go[j]->get_gateID();
+	}
+
+	piList.clear();
+	for (int i=0; i<inputGates.size(); i++)
+		piList.push_back(inputGates[i]->get_gateID());
+
+	poList.clear();
+	for (int i=0; i<outputGates.size(); i++)
+		poList.push_back(outputGates[i]->get_gateID());
+
+	int loopGate = levelize();
+	if (loopGate >= 0) {
+		// Walk back through inputs that were never levelized until a gate repeats; the gates
+		// from its first visit on form a cycle.
+		vector<int> visit(numGates, -1);
+		vector<int> path;
+		int g = loopGate;
+		while (visit[g] < 0) {
+			visit[g] = path.size();
+			path.push_back(g);
+			for (int k=faninBegin(g); k<faninEnd(g); k++) {
+				if (level[faninAt(k)] < 0) {
+					g = faninAt(k);
+					break;
+				}
+			}
+		}
+		cout << "ERROR: Combinational loop through gates:";
+		for (int i=path.size()-1; i>=visit[g]; i--)
+			cout << " " << gates[path[i]]->get_outputName();
+		cout << endl;
+		assert(false);
+	}
+
+	bindGates(gates);
+}
+
+/** \brief Build the netlist from a netlist cache, instead of from the Gates.
+ *  \param gates All gates of the circuit, already created from the cache (see Circuit::setupFromCache()).
+ *  Gate \a i must have ID \a i.
+ *  \param cache A loaded cache (see NetlistCache::isLoaded())
+ *  \note As \a build(), this binds each Gate's storage to this netlist and sets its depth. The
+ *  circuit is not levelized again: the levels and level order come from the cache. All values
+ *  are LOGIC_UNSET, all faults NOFAULT and all SCOAP numbers CC_UNSET, as for new Gates.
+ */
+void Netlist::load(vector<Gate*>& gates, const NetlistCache& cache) {
+	assert(cache.isLoaded() && (gates.size() == cache.getNumberGates()));
+
+	numGates = cache.getNumberGates();
+	gateType.resize(numGates);
+	for (int i=0; i<numGates; i++)
+		gateType[i] = cache.getType(i);
+	gateValue.assign(numGates, LOGIC_UNSET);
+	faultType.assign(numGates, NOFAULT);
+	scoapStruct unset = {CC_UNSET, CC_UNSET, CC_UNSET};
+	scoap.assign(numGates, unset);
+
+	faninStart.assign(cache.getFaninStart(), cache.getFaninStart() + numGates + 1);
+	faninList.assign(cache.getFaninList(), cache.getFaninList() + faninStart[numGates]);
+	fanoutStart.assign(cache.getFanoutStart(), cache.getFanoutStart() + numGates + 1);
+	fanoutList.assign(cache.getFanoutList(), cache.getFanoutList() + fanoutStart[numGates]);
+	piList.assign(cache.getPIs(), cache.getPIs() + cache.getNumberPIs());
+	poList.assign(cache.getPOs(), cache.getPOs() + cache.getNumberPOs());
+	level.assign(cache.getLevels(), cache.getLevels() + numGates);
+	levelOrder.assign(cache.getLevelOrder(), cache.getLevelOrder() + numGates);
+
+	bindGates(gates);
+}
+
+/** \brief Private function for the last steps of \a build() and \a load(): picks each gate's
+ *  evaluation kernel, and binds each Gate's storage to this netlist and sets its depth.
+ */
+void Netlist::bindGates(vector<Gate*>& gates) {
+	// Pick each gate's evaluation kernel once, here, by its type and number of inputs.
+	kernel.resize(numGates);
+	for (int i=0; i<numGates; i++)
+		kernel[i] = kernelFor(gateType[i], faninStart[i+1] - faninStart[i]);
+
+	// From here on, the Gates read and write their values through the netlist.
+	for (int i=0; i<numGates; i++) {
+		gates[i]->bindStorage(&gateValue[i], &faultType[i], &scoap[i]);
+		gates[i]->setDepth(level[i]);
+	}
+}
+
+/** \brief Private function to compute the level of every gate and the level order.
+ *  A gate's level is 0 if it has no inputs (a PI), otherwise one more than the largest
+ *  level of its inputs. Uses Kahn's algorithm, so it runs in time linear in the netlist size.
+ *  \return -1 on success. If the circuit has a combinational loop, the ID of a gate that could
+ *  not be levelized; every such gate is left with level -1, and the level order is not built.
+ */
+int Netlist::levelize() {
+	level.assign(numGates, 0);
+
+	vector<int> pending(numGates);   // number of inputs not yet levelized
+	vector<int> ready;
+	for (int i=0; i<numGates; i++) {
+		pending[i] = faninEnd(i) - faninBegin(i);
+		if (pending[i] == 0)
+			ready.push_back(i);
+	}
+
+	int done = 0;
+	while (!ready.empty()) {
+		int g = ready.back();
+		ready.pop_back();
+		done++;
+		for (int k=fanoutBegin(g); k<fanoutEnd(g); k++) {
+			int out = fanoutAt(k);
+			if (level[out] < level[g] + 1)
+				level[out] = level[g] + 1;
+			if (--pending[out] == 0)
+				ready.push_back(out);
+		}
+	}
+	if (done < numGates) {
+		int stuck = -1;
+		for (int i=0; i<numGates; i++) {
+			if (pending[i] > 0) {
+				level[i] = -1;
+				if (stuck < 0)
+					stuck = i;
+			}
+		}
+		return stuck;
+	}
+
+	// counting sort by level; stable, so gates on the same level stay in ID order
+	vector<int> levelStart(getNumberLevels()+1, 0);
+	for (int i=0; i<numGates; i++)
+		levelStart[level[i]+1]++;
+	for (int l=0; l<getNumberLevels(); l++)
+		levelStart[l+1] += levelStart[l];
+	levelOrder.resize(numGates);
+	for (int i=0; i<numGates; i++)
+		levelOrder[levelStart[level[i]]++] = i;
+	return -1;
+}
+
+/** \brief Get the number of levels in the netlist.
+ *  \return One more than the largest gate level (0 for an empty netlist).
+ */
+int Netlist::getNumberLevels() const {
+	int maxLevel = -1;
+	for (int i=0; i<numGates; i++)
+		if (level[i] > maxLevel)
+			maxLevel = level[i];
+	return maxLevel + 1;
+}
+
+/** \brief Private helper: a logicKernel for gates of type \a T with \a N inputs, or any number
+ *  of inputs if \a N is 0. The inputs are folded through the Logic tables (see ClassLogic.cc);
+ *  with \a T and \a N fixed, the table rows are constant and the loop is unrolled.
+ */
+template<int T, int N>
+static char evaluateKernel(const int* in, int n, const char* values) {
+	const int count = (N > 0) ? N : n;
+	int state = Logic::startTable[T];
+	for (int i=0; i<count; i++)
+		state = Logic::foldTable[T][state][values[in[i]]];
+	return Logic::outputTable[T][state];
+}
+
+#define LOGIC_KERNELS(t) evaluateKernel<t, 0>, evaluateKernel<t, 1>, evaluateKernel<t, 2>, \
+	evaluateKernel<t, 3>, evaluateKernel<t, 4>
+
+/** The logicKernel of each kernel number (see \a kernelFor()). */
+const logicKernel Netlist::logicKernels[NUM_KERNELS] = {
+	LOGIC_KERNELS(0), LOGIC_KERNELS(1), LOGIC_KERNELS(2), LOGIC_KERNELS(3), LOGIC_KERNELS(4),
+	LOGIC_KERNELS(5), LOGIC_KERNELS(6), LOGIC_KERNELS(7), LOGIC_KERNELS(8), LOGIC_KERNELS(9),
+	LOGIC_KERNELS(10)
+};
+
+/** \brief Private helper: \a v, saturated at SCOAP_MAX so that deep circuits cannot overflow an int. */
+static inline int scoapSaturate(long long v) {
+	return (v > SCOAP_MAX) ? SCOAP_MAX : (int)v;
+}
+
+/** \brief Computes the SCOAP numbers (CC0, CC1 and CO) of every gate.
+ *  Two linear passes over the level order: a forward pass sets the controllabilities of each
+ *  gate from those of its inputs, then a reverse pass sets the observability of each gate from
+ *  those of the gates it drives. A FANOUT gate adds nothing, so a fanout stem gets the smallest
+ *  CO of its branches. All sums saturate at SCOAP_MAX.
+ *  \note A gate that does not reach any PO has a CO of CC_UNSET.
+ */
+void Netlist::computeSCOAP() {
+	for (int i=0; i<numGates; i++) {
+		int g = levelOrder[i];
+		char t = gateType[g];
+		scoapStruct& s = scoap[g];
+		if (t == GATE_PI) {
+			s.cc0 = CC_IN;
+			s.cc1 = CC_IN;
+			continue;
+		}
+
+		long long cc0, cc1;
+		int first = faninList[faninBegin(g)];
+		if ((t == GATE_AND) || (t == GATE_NAND) || (t == GATE_OR) || (t == GATE_NOR)) {
+			// AND: CC0 = min CC0 + 1, CC1 = sum CC1 + 1; OR is the dual
+			long long minCC0 = scoap[first].cc0, minCC1 = scoap[first].cc1, sumCC0 = 0, sumCC1 = 0;
+			for (int k=faninBegin(g); k<faninEnd(g); k++) {
+				const scoapStruct& in = scoap[faninList[k]];
+				sumCC0 += in.cc0;
+				sumCC1 += in.cc1;
+				if (in.cc0 < minCC0) minCC0 = in.cc0;
+				if (in.cc1 < minCC1) minCC1 = in.cc1;
+			}
+			if ((t == GATE_AND) || (t == GATE_NAND)) {
+				cc0 = minCC0 + 1;
+				cc1 = sumCC1 + 1;
+			}
+			else {
+				cc0 = sumCC0 + 1;
+				cc1 = minCC1 + 1;
+			}
+			if ((t == GATE_NAND) || (t == GATE_NOR))
+				swap(cc0, cc1);
+		}
+		else if ((t == GATE_XOR) || (t == GATE_XNOR)) {
+			// cheapest way to make the parity of the inputs seen so far even (cc0) or odd (cc1)
+			cc0 = scoap[first].cc0;
+			cc1 = scoap[first].cc1;
+			for (int k=faninBegin(g)+1; k<faninEnd(g); k++) {
+				const scoapStruct& in = scoap[faninList[k]];
+				long long even = min(cc0 + in.cc0, cc1 + in.cc1);
+				long long odd = min(cc0 + in.cc1, cc1 + in.cc0);
+				cc0 = even;
+				cc1 = odd;
+			}
+			cc0++;
+			cc1++;
+			if (t == GATE_XNOR)
+				swap(cc0, cc1);
+		}
+		else if (t == GATE_NOT) {
+			cc0 = scoap[first].cc1 + 1;
+			cc1 = scoap[first].cc0 + 1;
+		}
+		else if (t == GATE_BUFF) {
+			cc0 = scoap[first].cc0 + 1;
+			cc1 = scoap[first].cc1 + 1;
+		}
+		else {   // GATE_FANOUT: a branch is as controllable as its stem
+			cc0 = scoap[first].cc0;
+			cc1 = scoap[first].cc1;
+		}
+		s.cc0 = scoapSaturate(cc0);
+		s.cc1 = scoapSaturate(cc1);
+	}
+
+	vector<char> isPO(numGates, 0);
+	for (int i=0; i<poList.size(); i++)
+		isPO[poList[i]] = 1;
+
+	for (int i=numGates-1; i>=0; i--) {
+		int g = levelOrder[i];
+		long long co = isPO[g] ? CO_OUT : SCOAP_MAX + 1LL;
+
+		// the cheapest way to observe g through any gate it drives
+		for (int k=fanoutBegin(g); k<fanoutEnd(g); k++) {
+			int out = fanoutAt(k);
+			if (scoap[out].co == CC_UNSET)
+				continue;
+			char t = gateType[out];
+			long long through = scoap[out].co;
+			if (t != GATE_FANOUT)
+				through++;
+			// the other inputs of out must be at their non-controlling values
+			// (for XOR and XNOR, whichever is cheaper)
+			bool seen = false;   // g may drive more than one input of out
+			for (int j=faninBegin(out); j<faninEnd(out); j++) {
+				int in = faninList[j];
+				if ((in == g) && !seen) {
+					seen = true;
+					continue;
+				}
+				if ((t == GATE_AND) || (t == GATE_NAND))
+					through += scoap[in].cc1;
+				else if ((t == GATE_OR) || (t == GATE_NOR))
+					through += scoap[in].cc0;
+				else if ((t == GATE_XOR) || (t == GATE_XNOR))
+					through += min(scoap[in].cc0, scoap[in].cc1);
+			}
+			if (through > SCOAP_MAX)
+				through = SCOAP_MAX;
+			if (through < co)
+				co = through;
+		}
+		scoap[g].co = (co > SCOAP_MAX) ? CC_UNSET : (int)co;
+	}
+}
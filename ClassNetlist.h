@@ -0,0 +1,121 @@
+#ifndef CLASSNETLIST_H
+#define CLASSNETLIST_H
+
+#include "ClassGate.h"
+#include "ClassLogic.h"
+#include <vector>    // vector
+#include <assert.h>  // assert
+#include <iostream>  // cout
+
+// Gates with up to this many inputs are evaluated by kernels specialized for their type and
+// number of inputs (see Netlist::getKernel()); wider gates use a generic kernel for their type.
+#define KERNEL_MAX_INPUTS 4
+#define NUM_KERNELS (LOGIC_GATE_TYPES * (KERNEL_MAX_INPUTS + 1))
+
+class CompiledSim;
+class NetlistCache;
+
+/** Evaluates a gate in the 5-valued logic from the values of its \a n inputs \a in; see Netlist::evaluate(). */
+typedef char (*logicKernel)(const int* in, int n, const char* values);
+
+class Netlist{
+
+ private:
+	int numGates;              // Number of gates; gate i here is the Gate with ID i.
+
+	vector<char> gateType;     // Gate type of each gate (GATE_* macros)
+	vector<char> gateValue;    // Logic value of each gate's output (LOGIC_* macros)
+	vector<char> faultType;    // Fault on each gate's output (NOFAULT, FAULT_SA0, FAULT_SA1)
+	vector<scoapStruct> scoap; // SCOAP numbers of each gate
+	vector<int> level;         // Level of each gate: 0 for PIs, otherwise 1 + the largest level of its inputs
+
+	// Connectivity in compressed sparse row (CSR) form: the inputs of gate g are
+	// faninList[faninStart[g]] ... faninList[faninStart[g+1]-1], in the same order as
+	// Gate::get_gateInputs(). Likewise for the outputs with fanoutStart/fanoutList.
+	vector<int> faninStart;
+	vector<int> faninList;
+	vector<int> fanoutStart;
+	vector<int> fanoutList;
+
+	vector<int> piList;        // IDs of the PI gates, in Circuit::getPIGates() order
+	vector<int> poList;        // IDs of the gates driving POs, in Circuit::getPOGates() order
+	vector<int> levelOrder;    // All gate IDs sorted by level (ties broken by ID)
+	vector<unsigned char> kernel; // Evaluation kernel of each gate, chosen once in build() (see getKernel())
+	const CompiledSim* compiledSim; // Compiled fault-free simulator for this netlist, or NULL
+
+	static const logicKernel logicKernels[NUM_KERNELS];
+
+	int levelize();
+	void bindGates(vector<Gate*>& gates);
+
+ public:
+	Netlist();
+	void build(vector<Gate*>& gates, vector<Gate*>& inputGates, vector<Gate*>& outputGates);
+	void load(vector<Gate*>& gates, const NetlistCache& cache);
+
+	int getNumberGates() const { return numGates; }
+	int getNumberLevels() const;
+
+	char getType(int g) const { return gateType[g]; }
+	char getValue(int g) const { return gateValue[g]; }
+	const char* getValues() const { return &gateValue[0]; }
+	void setValue(int g, char v) { gateValue[g] = v; }
+	char getFault(int g) const { return faultType[g]; }
+	int getLevel(int g) const { return level[g]; }
+	const scoapStruct& getSCOAP(int g) const { return scoap[g]; }
+	void computeSCOAP();
+
+	int faninBegin(int g) const { return faninStart[g]; }
+	int faninEnd(int g) const { return faninStart[g+1]; }
+	int faninAt(int k) const { return faninList[k]; }
+	int fanoutBegin(int g) const { return fanoutStart[g]; }
+	int fanoutEnd(int g) const { return fanoutStart[g+1]; }
+	int fanoutAt(int k) const { return fanoutList[k]; }
+
+	const vector<int>& getPIs() const { return piList; }
+	const vector<int>& getPOs() const { return poList; }
+	const vector<int>& getLevelOrder() const { return levelOrder; }
+
+	int getKernel(int g) const { return kernel[g]; }
+	const CompiledSim* getCompiledSim() const { return compiledSim; }
+	void setCompiledSim(const CompiledSim* cs) { compiledSim = cs; }
+	static int kernelFor(char t, int n) { return t * (KERNEL_MAX_INPUTS + 1) + ((n <= KERNEL_MAX_INPUTS) ? n : 0); }
+	static int genericKernel(char t) { return kernelFor(t, KERNEL_MAX_INPUTS + 1); }
+
+	char evaluate(int g) const { return evaluate(g, &gateValue[0]); }
+	char evaluate(int g, const char* values) const { return evaluateWith(kernel[g], g, values); }
+	char evaluateWith(int k, int g, const char* values) const;
+	char applyFault(int g, char v) const { return injectFault(faultType[g], v); }
+	static char injectFault(char fault, char v);
+};
+
+// evaluateWith() and injectFault() are called for every gate evaluation in the PODEM
+// simulators, so they are defined here to be inlined.
+
+/** \brief Computes the output value of gate \a g from the values of its inputs.
+ *  \param k The kernel to use: \a getKernel(g) (which \a evaluate() uses), or \a genericKernel()
+ *  of the gate's type, e.g. to compare the two
+ *  \param g A gate ID. All of its inputs must already have a value (not LOGIC_UNSET).
+ *  \param values The value of every gate, indexed by gate ID. \a evaluate(g) uses the
+ *  netlist's own values; a PodemWorker passes its private copy.
+ *  \return The fault-free output value of the gate, using the LOGIC_* macros. Use
+ *  \a applyFault() to account for a fault on the gate's output.
+ *  \note This gives exactly the same result as folding the inputs through Logic::fold().
+ */
+inline char Netlist::evaluateWith(int k, int g, const char* values) const {
+	return logicKernels[k](faninList.data() + faninStart[g], faninStart[g+1] - faninStart[g], values);
+}
+
+
+/** \brief Accounts for a fault on a gate's output.
+ *  \param fault NOFAULT, FAULT_SA0 or FAULT_SA1
+ *  \param v The fault-free value of the gate's output
+ *  \return The value seen on the gate's output: \a v with D or D' substituted if the fault is
+ *  activated. \a applyFault() does this for the fault stored in the netlist.
+ *  \note This matches setValueForError() in main.cc.
+ */
+inline char Netlist::injectFault(char fault, char v) {
+	return Logic::injectFault(fault, v);
+}
+
+#endif
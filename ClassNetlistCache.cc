@@ -0,0 +1,331 @@
+/** \class NetlistCache
+ * \brief A binary file holding a circuit's netlist after setup, so later runs can skip parsing.
+ *
+ * Reading a .bench file parses it with flex and bison, connects the gates by looking up each
+ * input by name, inserts the FANOUT gates and levelizes the circuit (see Circuit::setupCircuit()).
+ * \a write() saves the result of all of that: the gate types and names, the fanin and fanout
+ * lists in the CSR form of the Netlist, the PIs and POs, and each gate's level and the level order.
+ * A later run maps the file into memory (mmap) and builds the Circuit straight from these arrays
+ * with Circuit::setupFromCache().
+ *
+ * The file is a netlistCacheHeader followed by these arrays, with no padding:
+ *
+ *     int32_t faninStart[numGates+1], faninList[numFanins]
+ *     int32_t fanoutStart[numGates+1], fanoutList[numFanouts]
+ *     int32_t piList[numPIs], poList[numPOs]
+ *     int32_t level[numGates], levelOrder[numGates]
+ *     int32_t nameStart[numGates+1]
+ *     char gateType[numGates], names[nameBytes]    (gate g's name is names[nameStart[g]] ...)
+ *
+ * The header holds a checksum of the .bench file, so a cache is not used once the .bench file
+ * changes, and a checksum of the arrays, so a damaged file is not used either. A file from
+ * another version of the format (NETLIST_CACHE_VERSION) or another compiler layout is also
+ * ignored. In all of those cases \a isLoaded() is false, and the caller should parse the .bench
+ * file and \a write() the cache again. The values are in the byte order of the machine, so a
+ * cache is only meant to be used on the machine that wrote it.
+ *
+ * \a fileFor() names the cache of a .bench file by the checksum of its contents, in the
+ * directory given, or $ATPG_CACHE_DIR, or ".atpg_cache" (as for CompiledSim). Two .bench files
+ * with the same base name in different directories therefore never share (and keep
+ * overwriting) one cache file, and a copy of a .bench file uses the same cache.
+ *
+ * Besides the checksums, every index, type and name is checked before the cache is used (see
+ * \a validate()), so a wrong file is never used to build a circuit.
+ */
+
+#include "ClassNetlistCache.h"
+#include "ClassCircuit.h"
+#include <vector>      // vector
+#include <unordered_set> // unordered_set
+#include <string.h>    // memcmp, memcpy
+#include <stdio.h>     // fopen, fwrite, rename, remove, snprintf
+#include <stdlib.h>    // getenv
+#include <unistd.h>    // close, getpid
+#include <fcntl.h>     // open
+#include <sys/stat.h>  // fstat, mkdir
+#include <sys/mman.h>  // mmap, munmap
+
+static const char netlistCacheMagic[8] = "ATPGNET";
+
+/** \brief Maps a netlist cache file and checks it.
+ *  \param fileName The cache file (see \a fileFor())
+ *  \param benchChecksum The checksum of the .bench file now (see \a checksumFile())
+ *  If the file is missing, was written for another .bench file or another version, or is
+ *  damaged, the cache is not loaded (see \a isLoaded()).
+ */
+NetlistCache::NetlistCache(const string& fileName, uint64_t benchChecksum) {
+	data = NULL;
+	size = 0;
+	header = NULL;
+	if (!map(fileName, benchChecksum))
+		unmap();
+}
+
+/** \brief Destructor: unmaps the file. */
+NetlistCache::~NetlistCache() {
+	unmap();
+}
+
+/** \brief Private function that maps the file and sets the array pointers.
+ *  \return True if the file is a valid cache for this .bench file.
+ */
+bool NetlistCache::map(const string& fileName, uint64_t benchChecksum) {
+	int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if ((fstat(fd, &st) != 0) || (st.st_size < sizeof(netlistCacheHeader))) {
+		close(fd);
+		return false;
+	}
+	size = st.st_size;
+	data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		data = NULL;
+		return false;
+	}
+
+	const netlistCacheHeader* h = (const netlistCacheHeader*)data;
+	if ((memcmp(h->magic, netlistCacheMagic, sizeof(h->magic)) != 0) || (h->version != NETLIST_CACHE_VERSION) ||
+	    (h->headerSize != sizeof(netlistCacheHeader)) || (h->benchChecksum != benchChecksum))
+		return false;
+	if ((h->numGates < 0) || (h->numPIs < 0) || (h->numPOs < 0) || (h->numFanins < 0) ||
+	    (h->numFanouts < 0) || (h->nameBytes < 0))
+		return false;
+
+	long long n = h->numGates;
+	long long ints = 5*n + 3 + h->numFanins + h->numFanouts + h->numPIs + h->numPOs;
+	if (size != sizeof(netlistCacheHeader) + ints * sizeof(int32_t) + n + h->nameBytes)
+		return false;
+	if (checksum((const char*)data + sizeof(netlistCacheHeader), size - sizeof(netlistCacheHeader)) != h->dataChecksum)
+		return false;
+
+	const int32_t* p = (const int32_t*)(h + 1);
+	faninStart = p;     p += n + 1;
+	faninList = p;      p += h->numFanins;
+	fanoutStart = p;    p += n + 1;
+	fanoutList = p;     p += h->numFanouts;
+	piList = p;         p += h->numPIs;
+	poList = p;         p += h->numPOs;
+	level = p;          p += n;
+	levelOrder = p;     p += n;
+	nameStart = p;      p += n + 1;
+	gateType = (const char*)p;
+	names = gateType + n;
+
+	if (!validate(h))
+		return false;
+	header = h;
+	return true;
+}
+
+/** \brief Private function that checks every index, type and name in the mapped arrays.
+ *  \param h The header, already checked against the size of the file
+ *  \return True if the circuit can be built from the arrays without any access out of bounds
+ *  or failed assert.
+ *  The checksum only finds a damaged file; this also rejects a file that was written wrongly
+ *  (or by hand) with a valid checksum. Each start array must grow from 0 to the length of its
+ *  list, every gate ID in a list must be a gate, every type a gate type (with the number of
+ *  inputs the kernels expect for it), the fanouts must match the fanins, the level order must
+ *  be a permutation of the gates in nondecreasing level, and every gate's level must be above
+ *  those of its inputs. Every gate must have a name, and no two the same one, as
+ *  Circuit::newGate() asserts.
+ */
+bool NetlistCache::validate(const netlistCacheHeader* h) const {
+	int n = h->numGates;
+	const int32_t* starts[3] = {faninStart, fanoutStart, nameStart};
+	for (int a=0; a<3; a++) {
+		if (starts[a][0] != 0)
+			return false;
+		for (int g=0; g<n; g++)
+			if (starts[a][g+1] < starts[a][g])
+				return false;
+	}
+	if ((faninStart[n] != h->numFanins) || (fanoutStart[n] != h->numFanouts) || (nameStart[n] != h->nameBytes))
+		return false;
+
+	for (int k=0; k<h->numFanins; k++)
+		if ((faninList[k] < 0) || (faninList[k] >= n))
+			return false;
+	for (int k=0; k<h->numFanouts; k++)
+		if ((fanoutList[k] < 0) || (fanoutList[k] >= n))
+			return false;
+	for (int i=0; i<h->numPIs; i++)
+		if ((piList[i] < 0) || (piList[i] >= n) || (gateType[piList[i]] != GATE_PI))
+			return false;
+	for (int i=0; i<h->numPOs; i++)
+		if ((poList[i] < 0) || (poList[i] >= n))
+			return false;
+
+	for (int g=0; g<n; g++) {
+		char t = gateType[g];
+		int numInputs = faninStart[g+1] - faninStart[g];
+		if ((t < GATE_NAND) || ((t > GATE_NOT) && (t != GATE_PI) && (t != GATE_FANOUT)))
+			return false;
+		if ((t == GATE_PI) ? (numInputs != 0) :
+		    ((t == GATE_BUFF) || (t == GATE_NOT) || (t == GATE_FANOUT)) ? (numInputs != 1) : (numInputs < 1))
+			return false;
+		// each fanout of g lists g as an input
+		for (int k=fanoutStart[g]; k<fanoutStart[g+1]; k++) {
+			int out = fanoutList[k];
+			bool found = false;
+			for (int j=faninStart[out]; (j<faninStart[out+1]) && !found; j++)
+				found = (faninList[j] == g);
+			if (!found)
+				return false;
+		}
+	}
+	// ... and as many times as g is an input in all
+	vector<int> uses(n, 0);
+	for (int k=0; k<h->numFanins; k++)
+		uses[faninList[k]]++;
+	for (int g=0; g<n; g++)
+		if (uses[g] != fanoutStart[g+1] - fanoutStart[g])
+			return false;
+
+	vector<char> seen(n, 0);
+	for (int i=0; i<n; i++) {
+		int g = levelOrder[i];
+		if ((g < 0) || (g >= n) || seen[g])
+			return false;
+		seen[g] = 1;
+		if ((level[g] < 0) || (level[g] >= n) || ((i > 0) && (level[g] < level[levelOrder[i-1]])))
+			return false;
+		for (int k=faninStart[g]; k<faninStart[g+1]; k++)
+			if (level[faninList[k]] >= level[g])
+				return false;
+	}
+
+	unordered_set<string> names;
+	for (int g=0; g<n; g++)
+		if ((nameStart[g+1] == nameStart[g]) || !names.insert(getName(g)).second)
+			return false;
+	return true;
+}
+
+/** \brief Private function that unmaps the file, if it is mapped. */
+void NetlistCache::unmap() {
+	if (data != NULL)
+		munmap(data, size);
+	data = NULL;
+	size = 0;
+	header = NULL;
+}
+
+/** \brief Writes the netlist cache of a circuit.
+ *  \param fileName The cache file (see \a fileFor()); its directory is created if needed
+ *  \param benchChecksum The checksum of the .bench file the circuit was read from (see \a checksumFile())
+ *  \param c The circuit, after Circuit::setupCircuit()
+ *  \return False if the file cannot be written.
+ *  The file is written under a temporary name and then renamed, so other runs never map a partial file.
+ */
+bool NetlistCache::write(const string& fileName, uint64_t benchChecksum, Circuit* c) {
+	Netlist* nl = c->getNetlist();
+	int n = nl->getNumberGates();
+
+	int numFanins = (n > 0) ? nl->faninEnd(n-1) : 0;
+	int numFanouts = (n > 0) ? nl->fanoutEnd(n-1) : 0;
+
+	// all the int32_t arrays, in file order
+	vector<int32_t> ints;
+	ints.reserve(5*n + 3 + numFanins + numFanouts + nl->getPIs().size() + nl->getPOs().size());
+	for (int g=0; g<=n; g++)
+		ints.push_back((g == 0) ? 0 : nl->faninEnd(g-1));
+	for (int k=0; k<numFanins; k++)
+		ints.push_back(nl->faninAt(k));
+	for (int g=0; g<=n; g++)
+		ints.push_back((g == 0) ? 0 : nl->fanoutEnd(g-1));
+	for (int k=0; k<numFanouts; k++)
+		ints.push_back(nl->fanoutAt(k));
+	ints.insert(ints.end(), nl->getPIs().begin(), nl->getPIs().end());
+	ints.insert(ints.end(), nl->getPOs().begin(), nl->getPOs().end());
+	for (int g=0; g<n; g++)
+		ints.push_back(nl->getLevel(g));
+	ints.insert(ints.end(), nl->getLevelOrder().begin(), nl->getLevelOrder().end());
+
+	// the gate types, then the names
+	string chars;
+	for (int g=0; g<n; g++)
+		chars += nl->getType(g);
+	ints.push_back(0);
+	for (int g=0; g<n; g++) {
+		chars += c->getGate(g)->get_outputName();
+		ints.push_back(chars.size() - n);
+	}
+
+	netlistCacheHeader h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, netlistCacheMagic, sizeof(h.magic));
+	h.version = NETLIST_CACHE_VERSION;
+	h.headerSize = sizeof(netlistCacheHeader);
+	h.benchChecksum = benchChecksum;
+	h.numGates = n;
+	h.numPIs = nl->getPIs().size();
+	h.numPOs = nl->getPOs().size();
+	h.numFanins = numFanins;
+	h.numFanouts = numFanouts;
+	h.nameBytes = chars.size() - n;
+	h.dataChecksum = checksum(chars.data(), chars.size(), checksum(ints.data(), ints.size() * sizeof(int32_t)));
+
+	size_t slash = fileName.rfind('/');
+	if (slash != string::npos)
+		mkdir(fileName.substr(0, slash).c_str(), 0755);
+	string tmpName = fileName + ".tmp" + to_string(getpid());
+	FILE* f = fopen(tmpName.c_str(), "wb");
+	if (f == NULL)
+		return false;
+	bool ok = (fwrite(&h, sizeof(h), 1, f) == 1);
+	ok = ok && (fwrite(ints.data(), sizeof(int32_t), ints.size(), f) == ints.size());
+	ok = ok && (fwrite(chars.data(), 1, chars.size(), f) == chars.size());
+	ok = (fclose(f) == 0) && ok;
+	if (!ok || (rename(tmpName.c_str(), fileName.c_str()) != 0)) {
+		remove(tmpName.c_str());
+		return false;
+	}
+	return true;
+}
+
+/** \brief The 64-bit FNV-1a checksum of \a n bytes at \a p.
+ *  \param h The checksum of the bytes before these, to checksum several pieces as one
+ */
+uint64_t NetlistCache::checksum(const void* p, size_t n, uint64_t h) {
+	const unsigned char* bytes = (const unsigned char*)p;
+	for (size_t i=0; i<n; i++) {
+		h ^= bytes[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+/** \brief Computes the checksum of a file (see \a checksum()).
+ *  \param fileName The file, e.g. a .bench file
+ *  \param sum Set to the checksum
+ *  \return False if the file cannot be read.
+ */
+bool NetlistCache::checksumFile(const string& fileName, uint64_t& sum) {
+	FILE* f = fopen(fileName.c_str(), "rb");
+	if (f == NULL)
+		return false;
+	sum = checksum(NULL, 0);
+	char buffer[1 << 16];
+	size_t n;
+	while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+		sum = checksum(buffer, n, sum);
+	bool ok = !ferror(f);
+	fclose(f);
+	return ok;
+}
+
+/** \brief The name of the cache file of a .bench file (see the class description).
+ *  \param benchChecksum The checksum of the .bench file (see \a checksumFile())
+ *  \param cacheDir The cache directory; empty for the default
+ */
+string NetlistCache::fileFor(uint64_t benchChecksum, const string& cacheDir) {
+	string dir = cacheDir;
+	if (dir.empty())
+		dir = (getenv("ATPG_CACHE_DIR") != NULL) ? getenv("ATPG_CACHE_DIR") : ".atpg_cache";
+	char name[32];
+	snprintf(name, sizeof(name), "net_%016llx.net", (unsigned long long)benchChecksum);
+	return dir + "/" + name;
+}
@@ -0,0 +1,80 @@
+#ifndef CLASSNETLISTCACHE_H
+#define CLASSNETLISTCACHE_H
+
+#include <string>    // string
+#include <stdint.h>  // uint64_t, uint32_t, int32_t
+#include <stddef.h>  // size_t
+using namespace std;
+
+// Change this whenever the file layout (see ClassNetlistCache.cc) changes.
+#define NETLIST_CACHE_VERSION 2
+
+class Circuit;
+
+/** The fixed-size start of a netlist cache file. Every count is a number of entries, not bytes. */
+struct netlistCacheHeader {
+	char magic[8];           // "ATPGNET" and a 0
+	uint32_t version;        // NETLIST_CACHE_VERSION
+	uint32_t headerSize;     // sizeof(netlistCacheHeader), as a check on the compiler's layout
+	uint64_t benchChecksum;  // checksum of the .bench file the netlist was read from
+	uint64_t dataChecksum;   // checksum of everything after the header
+	int32_t numGates;
+	int32_t numPIs;
+	int32_t numPOs;
+	int32_t numFanins;       // total number of gate inputs
+	int32_t numFanouts;      // total number of gate outputs
+	int32_t nameBytes;       // total length of the gate names
+};
+
+class NetlistCache{
+
+ private:
+	void* data;              // the mapped file, or NULL
+	size_t size;             // its size in bytes
+	const netlistCacheHeader* header;
+
+	// The arrays in the file (see ClassNetlistCache.cc), set by the constructor
+	const int32_t* faninStart;
+	const int32_t* faninList;
+	const int32_t* fanoutStart;
+	const int32_t* fanoutList;
+	const int32_t* piList;
+	const int32_t* poList;
+	const int32_t* level;
+	const int32_t* levelOrder;
+	const int32_t* nameStart;
+	const char* gateType;
+	const char* names;
+
+	bool map(const string& fileName, uint64_t benchChecksum);
+	bool validate(const netlistCacheHeader* h) const;
+	void unmap();
+
+ public:
+	NetlistCache(const string& fileName, uint64_t benchChecksum);
+	~NetlistCache();
+
+	bool isLoaded() const { return header != NULL; }
+
+	int getNumberGates() const { return header->numGates; }
+	int getNumberPIs() const { return header->numPIs; }
+	int getNumberPOs() const { return header->numPOs; }
+	char getType(int g) const { return gateType[g]; }
+	string getName(int g) const { return string(names + nameStart[g], nameStart[g+1] - nameStart[g]); }
+
+	const int32_t* getFaninStart() const { return faninStart; }
+	const int32_t* getFaninList() const { return faninList; }
+	const int32_t* getFanoutStart() const { return fanoutStart; }
+	const int32_t* getFanoutList() const { return fanoutList; }
+	const int32_t* getPIs() const { return piList; }
+	const int32_t* getPOs() const { return poList; }
+	const int32_t* getLevels() const { return level; }
+	const int32_t* getLevelOrder() const { return levelOrder; }
+
+	static bool write(const string& fileName, uint64_t benchChecksum, Circuit* c);
+	static uint64_t checksum(const void* p, size_t n, uint64_t h = 14695981039346656037ULL);
+	static bool checksumFile(const string& fileName, uint64_t& sum);
+	static string fileFor(uint64_t benchChecksum, const string& cacheDir = "");
+};
+
+#endif
@@ -0,0 +1,327 @@
+/** \class PatternSim
+ * \brief A bit-parallel logic simulator that simulates many input patterns at once.
+ *
+ * The PatternSim works on a circuit's Netlist. Each gate's value is stored as two
+ * blocks of 64-bit words (a "two-rail" encoding), with bit \a i of each block belonging to
+ * pattern \a i:
+ * - bit set in the \a zero block: the value is 0
+ * - bit set in the \a one block: the value is 1
+ * - bit set in neither: the value is X
+ *
+ * With this encoding every gate is evaluated for all patterns with a few bitwise
+ * operations (e.g. for AND, one = AND of the input one-words and zero = OR of the
+ * input zero-words), walking the gates once in level order.
+ *
+ * The number of patterns is chosen when the simulator is constructed: 64 (one word per gate)
+ * by default, or e.g. PATTERNS_PER_BLOCK for bulk fault simulation. The gate evaluation
+ * kernel is picked at run time for the CPU: when the block is a multiple of 512 bits and the
+ * CPU has AVX-512, each gate is evaluated with 512-bit vector operations; otherwise with
+ * 256-bit AVX2 operations if the block is a multiple of 256 bits and the CPU has AVX2;
+ * otherwise one 64-bit word at a time. Within that instruction set, each gate is evaluated by
+ * a kernel specialized for its type and number of inputs (see Netlist::getKernel()).
+ *
+ * Typical use:
+ * - \a clearPatterns(), then \a setPattern() for up to getNumberPatterns() patterns
+ * - \a simulateGood() to compute the fault-free circuit
+ * - \a simulateFault() for each fault of interest; it reports the patterns that detect the
+ *   fault (the fault-free and faulty values differ on some PO, and neither is X).
+ *
+ * The PatternSim has its own value arrays: it never changes the values of the Gates or
+ * the Netlist.
+ */
+
+#include "ClassPatternSim.h"
+#include "ClassCompiledSim.h"
+#include <string.h>  // memcpy
+
+/** A 256-bit vector of patternWords (GCC vector extension); AVX2 registers. */
+typedef patternWord wordVec256 __attribute__((vector_size(32)));
+/** A 512-bit vector of patternWords (GCC vector extension); AVX-512 registers. */
+typedef patternWord wordVec512 __attribute__((vector_size(64)));
+
+// The vectors are passed by reference: passing or returning them by value from a function
+// not compiled for AVX would make GCC warn (-Wpsabi) that their ABI depends on the target.
+template<class V>
+static inline __attribute__((always_inline)) void loadWords(V& v, const patternWord* p) {
+	memcpy(&v, p, sizeof(V));
+}
+
+template<class V>
+static inline __attribute__((always_inline)) void storeWords(patternWord* p, const V& v) {
+	memcpy(p, &v, sizeof(V));
+}
+
+/** \brief Evaluates one gate on a block of words, \a V (a patternWord or a vector of them) at a time.
+ *  \param nl The netlist
+ *  \param g A gate ID, of type \a T, with \a N inputs (or any number of inputs if \a N is 0)
+ *  \param z The zero-rail blocks of every gate (gate \a h's block starts at z[h*numWords])
+ *  \param o The one-rail blocks of every gate
+ *  \param outZ Output: the zero-rail block of \a g's output, computed from its inputs
+ *  \param outO Output: the one-rail block of \a g's output, computed from its inputs
+ *  \param numWords Words per block; a multiple of the number of words in \a V
+ *  A PI simply keeps its current value. No fault is applied here.
+ *  With \a T and \a N fixed at compile time, the switch on the gate type is resolved and the
+ *  loop over the inputs is unrolled.
+ *  \note This is always inlined into one of the gateKernel functions below, so that it is
+ *  compiled for the instruction set of that kernel.
+ */
+template<class V, int T, int N>
+static inline __attribute__((always_inline)) void evaluateBlock(const Netlist* nl, int g, const patternWord* z, const patternWord* o,
+                                                                patternWord* outZ, patternWord* outO, int numWords) {
+	const int step = sizeof(V) / sizeof(patternWord);
+	const int first = nl->faninBegin(g);
+	const int count = (N > 0) ? N : (nl->faninEnd(g) - first);
+	V zeros = V();
+
+	// word offsets of the input blocks, looked up once for all words
+	int inputs[(N > 0) ? N : 1];
+	if (N > 0)
+		for (int k=0; k<N; k++)
+			inputs[k] = nl->faninAt(first + k) * numWords;
+#define INPUT_BLOCK(k) ((N > 0) ? inputs[k] : nl->faninAt(first + (k)) * numWords)
+
+	for (int w=0; w<numWords; w+=step) {
+		V rz, ro;
+		switch (T) {
+		case GATE_PI:
+			loadWords(rz, z + g*numWords + w);
+			loadWords(ro, o + g*numWords + w);
+			break;
+		case GATE_BUFF:
+		case GATE_FANOUT:
+			loadWords(rz, z + INPUT_BLOCK(0) + w);
+			loadWords(ro, o + INPUT_BLOCK(0) + w);
+			break;
+		case GATE_NOT:
+			loadWords(rz, o + INPUT_BLOCK(0) + w);
+			loadWords(ro, z + INPUT_BLOCK(0) + w);
+			break;
+		case GATE_AND:
+		case GATE_NAND:
+			rz = zeros;
+			ro = ~zeros;
+			for (int k=0; k<count; k++) {
+				V inZ, inO;
+				loadWords(inZ, z + INPUT_BLOCK(k) + w);
+				loadWords(inO, o + INPUT_BLOCK(k) + w);
+				rz |= inZ;
+				ro &= inO;
+			}
+			if (T == GATE_NAND)
+				swap(rz, ro);
+			break;
+		case GATE_OR:
+		case GATE_NOR:
+			rz = ~zeros;
+			ro = zeros;
+			for (int k=0; k<count; k++) {
+				V inZ, inO;
+				loadWords(inZ, z + INPUT_BLOCK(k) + w);
+				loadWords(inO, o + INPUT_BLOCK(k) + w);
+				rz &= inZ;
+				ro |= inO;
+			}
+			if (T == GATE_NOR)
+				swap(rz, ro);
+			break;
+		case GATE_XOR:
+		case GATE_XNOR:
+			// parity of all inputs; X if any input is X
+			loadWords(rz, z + INPUT_BLOCK(0) + w);
+			loadWords(ro, o + INPUT_BLOCK(0) + w);
+			for (int k=1; k<count; k++) {
+				V inZ, inO;
+				loadWords(inZ, z + INPUT_BLOCK(k) + w);
+				loadWords(inO, o + INPUT_BLOCK(k) + w);
+				V newZ = (rz & inZ) | (ro & inO);
+				V newO = (rz & inO) | (ro & inZ);
+				rz = newZ;
+				ro = newO;
+			}
+			if (T == GATE_XNOR)
+				swap(rz, ro);
+			break;
+		default:
+			assert(false);
+		}
+		storeWords(outZ + w, rz);
+		storeWords(outO + w, ro);
+	}
+#undef INPUT_BLOCK
+}
+
+// Each instruction set has one gateKernel per gate type and number of inputs, in the same order
+// as Netlist::logicKernels (see Netlist::kernelFor()).
+#define GATE_KERNELS(kernel, t) kernel<t, 0>, kernel<t, 1>, kernel<t, 2>, kernel<t, 3>, kernel<t, 4>
+#define GATE_KERNEL_TABLE(kernel) { \
+	GATE_KERNELS(kernel, 0), GATE_KERNELS(kernel, 1), GATE_KERNELS(kernel, 2), GATE_KERNELS(kernel, 3), \
+	GATE_KERNELS(kernel, 4), GATE_KERNELS(kernel, 5), GATE_KERNELS(kernel, 6), GATE_KERNELS(kernel, 7), \
+	GATE_KERNELS(kernel, 8), GATE_KERNELS(kernel, 9), GATE_KERNELS(kernel, 10) }
+
+/** \brief gateKernel using 64-bit words; works on any CPU and any block size. */
+template<int T, int N>
+static void evaluateScalar(const Netlist* nl, int g, const patternWord* z, const patternWord* o,
+                           patternWord* outZ, patternWord* outO, int numWords) {
+	evaluateBlock<patternWord, T, N>(nl, g, z, o, outZ, outO, numWords);
+}
+static const gateKernel scalarKernels[NUM_KERNELS] = GATE_KERNEL_TABLE(evaluateScalar);
+
+#if defined(__x86_64__) || defined(__i386__)
+/** \brief gateKernel using AVX2; needs a block size that is a multiple of 4 words. */
+template<int T, int N>
+__attribute__((target("avx2")))
+static void evaluateAVX2(const Netlist* nl, int g, const patternWord* z, const patternWord* o,
+                         patternWord* outZ, patternWord* outO, int numWords) {
+	evaluateBlock<wordVec256, T, N>(nl, g, z, o, outZ, outO, numWords);
+}
+static const gateKernel avx2Kernels[NUM_KERNELS] = GATE_KERNEL_TABLE(evaluateAVX2);
+
+/** \brief gateKernel using AVX-512; needs a block size that is a multiple of 8 words. */
+template<int T, int N>
+__attribute__((target("avx512f")))
+static void evaluateAVX512(const Netlist* nl, int g, const patternWord* z, const patternWord* o,
+                           patternWord* outZ, patternWord* outO, int numWords) {
+	evaluateBlock<wordVec512, T, N>(nl, g, z, o, outZ, outO, numWords);
+}
+static const gateKernel avx512Kernels[NUM_KERNELS] = GATE_KERNEL_TABLE(evaluateAVX512);
+#endif
+
+/** \brief Construct a new pattern simulator for a netlist.
+ *  \param nl The circuit's Netlist (see Circuit::getNetlist())
+ *  \param patterns The number of patterns to simulate at once; rounded up to a multiple of 64.
+ */
+PatternSim::PatternSim(Netlist* nl, int patterns) {
+	netlist = nl;
+	numWords = (patterns + PATTERNS_PER_WORD - 1) / PATTERNS_PER_WORD;
+	assert(numWords > 0);
+
+	kernels = scalarKernels;
+	kernelName = "scalar";
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_cpu_init();
+	if ((numWords % 8 == 0) && __builtin_cpu_supports("avx512f")) {
+		kernels = avx512Kernels;
+		kernelName = "avx512";
+	}
+	else if ((numWords % 4 == 0) && __builtin_cpu_supports("avx2")) {
+		kernels = avx2Kernels;
+		kernelName = "avx2";
+	}
+#endif
+
+	int n = nl->getNumberGates() * numWords;
+	goodZero.assign(n, 0);
+	goodOne.assign(n, 0);
+	zero.assign(n, 0);
+	one.assign(n, 0);
+	clearPatterns();
+}
+
+/** \brief Remove all loaded patterns (all PIs become X in every pattern). */
+void PatternSim::clearPatterns() {
+	piZero.assign(netlist->getPIs().size() * numWords, 0);
+	piOne.assign(netlist->getPIs().size() * numWords, 0);
+	loadedPatterns.assign(numWords, 0);
+}
+
+/** \brief Load one input pattern.
+ *  \param p Which pattern to set (0 to getNumberPatterns()-1)
+ *  \param pattern One value per PI, in Circuit::getPIGates() order, using the LOGIC_* macros.
+ *  LOGIC_D is treated as 1, LOGIC_DBAR as 0, and anything else as X.
+ */
+void PatternSim::setPattern(int p, const vector<char>& pattern) {
+	assert((p >= 0) && (p < getNumberPatterns()));
+	assert(pattern.size() * numWords == piZero.size());
+
+	int w = p / PATTERNS_PER_WORD;
+	patternWord bit = ((patternWord)1) << (p % PATTERNS_PER_WORD);
+	for (int i=0; i<pattern.size(); i++) {
+		piZero[i*numWords + w] &= ~bit;
+		piOne[i*numWords + w] &= ~bit;
+		if ((pattern[i] == LOGIC_ZERO) || (pattern[i] == LOGIC_DBAR))
+			piZero[i*numWords + w] |= bit;
+		else if ((pattern[i] == LOGIC_ONE) || (pattern[i] == LOGIC_D))
+			piOne[i*numWords + w] |= bit;
+	}
+	loadedPatterns[w] |= bit;
+}
+
+/** \brief Simulates the fault-free circuit for all loaded patterns.
+ *  Uses the netlist's compiled simulator, if it has one (see CompiledSim).
+ */
+void PatternSim::simulateGood() {
+	const CompiledSim* compiled = netlist->getCompiledSim();
+	if (compiled != NULL)
+		compiled->simulate(&piZero[0], &piOne[0], &goodZero[0], &goodOne[0], numWords);
+	else
+		simulate(goodZero, goodOne, -1, NOFAULT);
+}
+
+/** \brief Simulates the circuit with one stuck-at fault, for all loaded patterns.
+ *  \param faultGate The ID of the gate whose output is faulty
+ *  \param faultType FAULT_SA0 or FAULT_SA1
+ *  \param detected If not NULL, a block of getNumberWords() words; bit \a i is set if pattern
+ *  \a i detects the fault.
+ *  \return True if any loaded pattern detects the fault.
+ *  \note Run \a simulateGood() first (once per set of patterns).
+ */
+bool PatternSim::simulateFault(int faultGate, char faultType, patternWord* detected) {
+	simulate(zero, one, faultGate, faultType);
+
+	bool any = false;
+	const vector<int>& po = netlist->getPOs();
+	for (int w=0; w<numWords; w++) {
+		patternWord d = 0;
+		for (int i=0; i<po.size(); i++) {
+			int k = po[i]*numWords + w;
+			d |= (goodZero[k] & one[k]) | (goodOne[k] & zero[k]);
+		}
+		if (detected != NULL)
+			detected[w] = d;
+		any = any || (d != 0);
+	}
+	return any;
+}
+
+/** \brief Gets the fault-free value of a gate in one pattern.
+ *  \param g A gate ID
+ *  \param p Which pattern
+ *  \return LOGIC_ZERO, LOGIC_ONE or LOGIC_X
+ */
+char PatternSim::getGoodValue(int g, int p) const {
+	int k = g*numWords + p / PATTERNS_PER_WORD;
+	if ((goodZero[k] >> (p % PATTERNS_PER_WORD)) & 1)
+		return LOGIC_ZERO;
+	if ((goodOne[k] >> (p % PATTERNS_PER_WORD)) & 1)
+		return LOGIC_ONE;
+	return LOGIC_X;
+}
+
+/** \brief Private function that simulates all loaded patterns, in level order.
+ *  \param z Output: the zero-rail block of each gate
+ *  \param o Output: the one-rail block of each gate
+ *  \param faultGate ID of a gate whose output is stuck, or -1 for none
+ *  \param faultType FAULT_SA0 or FAULT_SA1 (ignored if \a faultGate is -1)
+ */
+void PatternSim::simulate(vector<patternWord>& z, vector<patternWord>& o, int faultGate, char faultType) {
+	const vector<int>& pi = netlist->getPIs();
+	for (int i=0; i<pi.size(); i++) {
+		for (int w=0; w<numWords; w++) {
+			z[pi[i]*numWords + w] = piZero[i*numWords + w];
+			o[pi[i]*numWords + w] = piOne[i*numWords + w];
+		}
+	}
+
+	const vector<int>& order = netlist->getLevelOrder();
+	for (int i=0; i<order.size(); i++) {
+		int g = order[i];
+		evaluateGate(g, &z[0], &o[0], &z[g*numWords], &o[g*numWords]);
+
+		if (g == faultGate) {
+			for (int w=0; w<numWords; w++) {
+				z[g*numWords + w] = (faultType == FAULT_SA0) ? loadedPatterns[w] : 0;
+				o[g*numWords + w] = (faultType == FAULT_SA1) ? loadedPatterns[w] : 0;
+			}
+		}
+	}
+}
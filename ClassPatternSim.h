@@ -0,0 +1,70 @@
+#ifndef CLASSPATTERNSIM_H
+#define CLASSPATTERNSIM_H
+
+#include "ClassNetlist.h"
+#include <vector>    // vector
+#include <stdint.h>  // uint64_t
+
+// Number of patterns in one patternWord: one per bit
+#define PATTERNS_PER_WORD 64
+
+// Number of patterns in a block of 8 words: one 512-bit (AVX-512) vector, or two 256-bit
+// (AVX2) vectors, per gate. Used for bulk fault simulation.
+#define PATTERNS_PER_BLOCK 512
+
+/** One bit per pattern. */
+typedef uint64_t patternWord;
+
+/** Evaluates one gate on a block of words; see PatternSim::evaluateGate(). */
+typedef void (*gateKernel)(const Netlist* nl, int g, const patternWord* z, const patternWord* o,
+                           patternWord* outZ, patternWord* outO, int numWords);
+
+class PatternSim{
+
+ private:
+	Netlist* netlist;
+	int numWords;                          // words per gate; the simulator holds numWords*64 patterns
+
+	const gateKernel* kernels;             // gate evaluation for this CPU and numWords, per Netlist::getKernel()
+	const char* kernelName;
+
+	// Two-rail encoding of each gate's value, one bit per pattern:
+	//   zero bit set --> 0, one bit set --> 1, neither set --> X.
+	// Gate g's words are [g*numWords, (g+1)*numWords).
+	vector<patternWord> goodZero, goodOne; // fault-free values, from simulateGood()
+	vector<patternWord> zero, one;         // values of the faulty circuit, from simulateFault()
+
+	vector<patternWord> piZero, piOne;     // the loaded patterns, per PI (in Netlist::getPIs() order)
+	vector<patternWord> loadedPatterns;    // bit i is set if pattern i has been loaded
+
+	void simulate(vector<patternWord>& z, vector<patternWord>& o, int faultGate, char faultType);
+
+ public:
+	PatternSim(Netlist* nl, int patterns = PATTERNS_PER_WORD);
+
+	int getNumberWords() const { return numWords; }
+	int getNumberPatterns() const { return numWords * PATTERNS_PER_WORD; }
+	const char* getKernelName() const { return kernelName; }
+
+	void clearPatterns();
+	void setPattern(int p, const vector<char>& pattern);
+	const patternWord* getLoadedPatterns() const { return &loadedPatterns[0]; }
+
+	void simulateGood();
+	bool simulateFault(int faultGate, char faultType, patternWord* detected = NULL);
+
+	char getGoodValue(int g, int p) const;
+	const patternWord* getGoodZero(int g) const { return &goodZero[g*numWords]; }
+	const patternWord* getGoodOne(int g) const { return &goodOne[g*numWords]; }
+
+	/** \brief Evaluates gate \a g for all patterns; see the gateKernel functions in ClassPatternSim.cc. */
+	void evaluateGate(int g, const patternWord* z, const patternWord* o, patternWord* outZ, patternWord* outO) const {
+		kernels[netlist->getKernel(g)](netlist, g, z, o, outZ, outO, numWords);
+	}
+	/** \brief As \a evaluateGate(), with kernel \a k: Netlist::getKernel(g) or the Netlist::genericKernel() of its type. */
+	void evaluateGateWith(int k, int g, const patternWord* z, const patternWord* o, patternWord* outZ, patternWord* outO) const {
+		kernels[k](netlist, g, z, o, outZ, outO, numWords);
+	}
+};
+
+#endif
@@ -0,0 +1,234 @@
+/** \class PodemPool
+ * \brief Runs PODEM on a list of faults with several threads, and hands out the results in fault order.
+ *
+ * Each thread has its own PodemWorker, so it has its own values, fault and search state, and
+ * all threads share the (read-only) Netlist. The faults are added with \a addFault() and
+ * targeted once \a start() is called.
+ *
+ * The time PODEM takes varies by orders of magnitude from fault to fault, so the faults are
+ * scheduled by work stealing. \a start() sorts them by their expected difficulty (the cost
+ * given to \a addFault(), e.g. from SCOAP), hardest first, and deals them out in turn to the
+ * threads' queues. Each thread runs the faults at the front of its own queue, so the hard
+ * faults are started early. A thread whose queue is empty steals the back half (the easiest
+ * faults) of another thread's queue, and stops once all queues are empty. Each thread counts
+ * its steals and the time it spends running PODEM; the rest of the pool's run time it was idle.
+ *
+ * The caller (the coordinator) asks for the results with \a getResult() in fault order, and
+ * waits for each fault that has not finished yet. Since each fault's result depends only on the
+ * fault, and not on which thread targeted it or when, the results come out the same for any
+ * number of threads.
+ *
+ * A fault can be dropped with \a dropFault(), e.g. because a test found for another fault
+ * detects it. A thread that has not started on it yet then skips it.
+ *
+ * A pool of one thread starts no threads: \a getResult() runs the faults itself, one at a time.
+ */
+
+#include "ClassPodemPool.h"
+#include <algorithm>  // stable_sort
+
+/** \brief Construct a pool of PODEM workers.
+ *  \param nl The circuit's Netlist (see Circuit::getNetlist())
+ *  \param mode The program's mode, which selects the PODEM heuristics (see PodemWorker)
+ *  \param numThreads The number of threads to run; at least 1
+ *  \param backtrackLimit Give up on a fault after this many backtracks; 0 for no limit
+ *  \param timeLimit Give up on a fault after this many seconds; 0 for no limit
+ */
+PodemPool::PodemPool(Netlist* nl, int mode, int numThreads, long backtrackLimit, double timeLimit) {
+	assert(numThreads >= 1);
+	for (int i=0; i<numThreads; i++) {
+		workers.push_back(new PodemWorker(nl, mode, backtrackLimit, timeLimit));
+		queues.push_back(new workQueue());
+		queues[i]->faultsRun = 0;
+		queues[i]->steals = 0;
+		queues[i]->busyTime = 0;
+	}
+	nextFault = 0;
+	runTime = 0;
+}
+
+/** \brief Destructor: waits for the threads (see \a finish()) and deletes the workers. */
+PodemPool::~PodemPool() {
+	finish();
+	for (int i=0; i<workers.size(); i++) {
+		delete workers[i];
+		delete queues[i];
+	}
+}
+
+/** \brief Add a fault to target. Faults can only be added before \a start().
+ *  \param g The ID of the gate whose output is faulty
+ *  \param type FAULT_SA0 or FAULT_SA1
+ *  \param cost The expected difficulty of the fault; faults with a higher cost are started first.
+ *  \return The index of the fault, used in \a getResult().
+ */
+int PodemPool::addFault(int g, char type, int cost) {
+	assert(threads.empty());
+	faultGate.push_back(g);
+	faultType.push_back(type);
+	faultCost.push_back(cost);
+	result.push_back(PODEM_UNDETECTABLE);
+	tests.push_back(vector<char>());
+	finished.push_back(0);
+	dropped.push_back(0);
+	return faultGate.size() - 1;
+}
+
+/** \brief Start the threads on the faults added so far. */
+void PodemPool::start() {
+	if (workers.size() == 1)
+		return;
+
+	// Hardest first; faults of equal cost stay in order.
+	vector<int> order(faultGate.size());
+	for (int f=0; f<order.size(); f++)
+		order[f] = f;
+	stable_sort(order.begin(), order.end(), [this](int a, int b) { return faultCost[a] > faultCost[b]; });
+	for (int i=0; i<order.size(); i++)
+		queues[i % queues.size()]->faults.push_back(order[i]);
+
+	startTime = chrono::steady_clock::now();
+	for (int i=0; i<workers.size(); i++)
+		threads.push_back(thread(&PodemPool::work, this, i));
+}
+
+/** \brief Get the result for a fault, waiting for it if it is not finished yet.
+ *  \param f The index of the fault (from \a addFault())
+ *  \param test If the result is PODEM_DETECTED, set to the test (see PodemWorker::getTest()).
+ *  \return PODEM_DETECTED, PODEM_UNDETECTABLE or PODEM_ABORTED (see PodemWorker::run()), or
+ *  PODEM_DROPPED if the fault was dropped before a thread started on it.
+ *  \note Call this once for each fault, in order; the pool does not keep the test afterwards.
+ */
+int PodemPool::getResult(int f, vector<char>& test) {
+	if (threads.empty()) {
+		while (!finished[f]) {
+			runFault(workers[0], nextFault++);
+			queues[0]->faultsRun++;
+		}
+	}
+	else {
+		unique_lock<mutex> lock(finishedLock);
+		while (!finished[f])
+			faultFinished.wait(lock);
+	}
+
+	test.swap(tests[f]);
+	tests[f].clear();
+	return result[f];
+}
+
+/** \brief Tell the pool that a fault no longer needs to be targeted.
+ *  \param f The index of the fault (from \a addFault())
+ *  If no thread has started on the fault yet, none will. Its result is PODEM_DROPPED then.
+ */
+void PodemPool::dropFault(int f) {
+	lock_guard<mutex> lock(finishedLock);
+	dropped[f] = 1;
+}
+
+/** \brief Wait for the threads to finish all faults. */
+void PodemPool::finish() {
+	if (threads.empty())
+		return;
+	for (int i=0; i<threads.size(); i++)
+		threads[i].join();
+	threads.clear();
+	runTime = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+}
+
+/** \brief Get the number of faults PODEM was run for, over all workers. */
+long long PodemPool::getNumberFaults() const {
+	long long n = 0;
+	for (int i=0; i<workers.size(); i++)
+		n += workers[i]->getNumberFaults();
+	return n;
+}
+
+/** \brief Get the number of PI values implied, over all workers. */
+long long PodemPool::getNumberImplications() const {
+	long long n = 0;
+	for (int i=0; i<workers.size(); i++)
+		n += workers[i]->getNumberImplications();
+	return n;
+}
+
+/** \brief Get the number of decisions undone, over all workers. */
+long long PodemPool::getNumberUndos() const {
+	long long n = 0;
+	for (int i=0; i<workers.size(); i++)
+		n += workers[i]->getNumberUndos();
+	return n;
+}
+
+/** \brief Get the number of gate evaluations, over all workers. */
+long long PodemPool::getNumberEvaluations() const {
+	long long n = 0;
+	for (int i=0; i<workers.size(); i++)
+		n += workers[i]->getNumberEvaluations();
+	return n;
+}
+
+/** \brief Private function: the body of thread \a w. Targets faults until none are left. */
+void PodemPool::work(int w) {
+	workQueue& q = *queues[w];
+	int f;
+	while ((f = takeFault(w)) >= 0) {
+		chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+		runFault(workers[w], f);
+		q.busyTime += chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+		q.faultsRun++;
+	}
+}
+
+/** \brief Private function: takes the next fault for thread \a w, stealing if its own queue is empty.
+ *  \return The fault index, or -1 if no thread has any faults left.
+ *  \note At most one queue is locked at a time.
+ */
+int PodemPool::takeFault(int w) {
+	workQueue& own = *queues[w];
+	{
+		lock_guard<mutex> lock(own.lock);
+		if (!own.faults.empty()) {
+			int f = own.faults.front();
+			own.faults.pop_front();
+			return f;
+		}
+	}
+
+	// Faults are never added once the threads start, so one pass over the other queues is enough.
+	vector<int> stolen;
+	for (int i=1; i<queues.size(); i++) {
+		workQueue& victim = *queues[(w + i) % queues.size()];
+		lock_guard<mutex> lock(victim.lock);
+		int n = (victim.faults.size() + 1) / 2;
+		if (n == 0)
+			continue;
+		stolen.assign(victim.faults.end() - n, victim.faults.end());
+		victim.faults.erase(victim.faults.end() - n, victim.faults.end());
+		break;
+	}
+	if (stolen.empty())
+		return -1;
+
+	own.steals++;
+	lock_guard<mutex> lock(own.lock);
+	own.faults.insert(own.faults.end(), stolen.begin() + 1, stolen.end());
+	return stolen[0];
+}
+
+/** \brief Private function: targets fault \a f with worker \a w and stores the result. */
+void PodemPool::runFault(PodemWorker* w, int f) {
+	bool skip;
+	{
+		lock_guard<mutex> lock(finishedLock);
+		skip = dropped[f];
+	}
+	int res = skip ? PODEM_DROPPED : w->run(faultGate[f], faultType[f]);
+	if (res == PODEM_DETECTED)
+		w->getTest(tests[f]);
+	result[f] = res;
+
+	lock_guard<mutex> lock(finishedLock);
+	finished[f] = 1;
+	faultFinished.notify_all();
+}
@@ -0,0 +1,71 @@
+#ifndef CLASSPODEMPOOL_H
+#define CLASSPODEMPOOL_H
+
+#include "ClassPodemWorker.h"
+#include <vector>              // vector
+#include <thread>              // thread
+#include <mutex>               // mutex, unique_lock
+#include <condition_variable>  // condition_variable
+#include <deque>               // deque
+#include <chrono>              // steady_clock
+
+// Result of PodemPool::getResult() for a fault dropped (see PodemPool::dropFault()) before it was targeted
+#define PODEM_DROPPED 3
+
+class PodemPool{
+
+ private:
+	vector<PodemWorker*> workers;          // one per thread
+	vector<thread> threads;                // empty if the pool runs faults on the caller's thread
+
+	// The faults each thread has yet to run, hardest first, and its statistics
+	struct workQueue {
+		mutex lock;                        // guards faults
+		deque<int> faults;
+		long long faultsRun;
+		long long steals;                  // number of times this thread stole faults
+		double busyTime;                   // seconds spent running PODEM
+	};
+	vector<workQueue*> queues;             // one per thread
+	chrono::steady_clock::time_point startTime;
+	double runTime;                        // seconds from start() until all threads finished
+
+	vector<int> faultGate;                 // gate ID of each fault
+	vector<char> faultType;                // FAULT_SA0 or FAULT_SA1, per fault
+	vector<int> faultCost;                 // expected difficulty of each fault
+	vector<char> result;                   // PODEM_* result of each finished fault
+	vector<vector<char> > tests;           // the test found for each finished, detected fault
+	vector<char> finished;                 // 1 once a fault's result is stored
+	vector<char> dropped;                  // 1 if a fault no longer needs to be targeted
+
+	int nextFault;                         // the next fault to run when there are no threads
+	mutex finishedLock;                    // guards finished and dropped
+	condition_variable faultFinished;      // signalled whenever a fault finishes
+
+	void work(int w);
+	int takeFault(int w);
+	void runFault(PodemWorker* w, int f);
+
+ public:
+	PodemPool(Netlist* nl, int mode, int numThreads, long backtrackLimit = 0, double timeLimit = 0);
+	~PodemPool();
+
+	int addFault(int g, char type, int cost = 0);
+	void start();
+	int getResult(int f, vector<char>& test);
+	void dropFault(int f);
+	void finish();
+
+	long long getNumberFaults() const;
+	long long getNumberImplications() const;
+	long long getNumberUndos() const;
+	long long getNumberEvaluations() const;
+
+	int getNumberThreads() const { return queues.size(); }
+	long long getNumberRun(int w) const { return queues[w]->faultsRun; }
+	long long getNumberSteals(int w) const { return queues[w]->steals; }
+	double getBusyTime(int w) const { return queues[w]->busyTime; }
+	double getIdleTime(int w) const { return runTime - queues[w]->busyTime; }
+};
+
+#endif
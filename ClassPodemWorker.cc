@@ -0,0 +1,514 @@
+/** \class PodemWorker
+ * \brief The PODEM engine: targets one fault at a time, with its own gate values, so several faults can be targeted at once.
+ *
+ * A PodemWorker keeps all of the search state itself: a private value array, the fault, the
+ * D-frontier, the event queue, the decision stack and the value trail. It reads only the
+ * structure of the Netlist (gate types and connectivity) and, in mode 6, its SCOAP numbers,
+ * none of which change after Circuit::setupCircuit() (and setSCOAPValues() in main.cc), so any
+ * number of PodemWorkers can run on the same Netlist in different threads (see PodemPool).
+ * Every mode runs its PODEM through a PodemWorker.
+ *
+ * The search is iterative, with an explicit stack of decisions: each entry is one level of
+ * the recursion of textbook PODEM. Backtracking does not re-simulate: every value change is
+ * journaled on the value trail, and undoing a decision pops the trail back to where it was
+ * before the decision (see \a undo()). Only the flipped value of a PI is simulated. A decision
+ * on a PI with the fault is not flipped, and when it fails the PI keeps its value; such
+ * decisions are kept, and assigned again whenever an undo removes them.
+ *
+ * The mode given to the constructor (the program's mode) selects the heuristics:
+ *  - Mode 1 implies each PI value with a full-circuit simulation in level order, and then
+ *    rebuilds the D-frontier. All other modes use event-driven simulation with a levelized
+ *    queue (see LevelQueue), which keeps the D-frontier up to date as values change.
+ *  - Modes 1, 2 and 3 take the D-frontier gate with the smallest ID and its first X input,
+ *    treating XOR as OR and XNOR as NOR, and backtrace through the first X input of each gate.
+ *  - Modes 4 and 5 do the same, but with a pseudo-random D-frontier gate. The generator is
+ *    seeded from the fault, so the test found for a fault does not depend on which worker
+ *    targets it, or on what it targeted before.
+ *  - Mode 6 is guided by SCOAP (see getSCOAPObjective() and scoapBacktrace()).
+ */
+
+#include "ClassPodemWorker.h"
+
+/** \brief Construct a new PODEM worker for a netlist.
+ *  \param nl The circuit's Netlist (see Circuit::getNetlist())
+ *  \param mode The program's mode (1 through 6), which selects the heuristics. In mode 6 the
+ *  netlist's SCOAP numbers must be computed before \a run() is called.
+ *  \param backtracks Give up on a fault after this many backtracks; 0 for no limit
+ *  \param seconds Give up on a fault after this much time; 0 for no limit
+ */
+PodemWorker::PodemWorker(Netlist* nl, int mode, long backtracks, double seconds)
+	: values(nl->getNumberGates(), LOGIC_X), dFrontier(nl, &values[0]), events(nl),
+	  isPO(nl->getNumberGates(), 0), xPathMark(nl->getNumberGates(), 0) {
+	netlist = nl;
+	for (int i=0; i<nl->getPOs().size(); i++)
+		isPO[nl->getPOs()[i]] = 1;
+	xPathStamp = 0;
+	this->mode = mode;
+	faultGate = -1;
+	faultType = NOFAULT;
+	backtrackLimit = backtracks;
+	timeLimit = seconds;
+	numFaults = 0;
+	numImplications = 0;
+	numUndos = 0;
+	numEvaluations = 0;
+}
+
+/** \brief Runs PODEM for one fault.
+ *  \param g The ID of the gate whose output is faulty
+ *  \param type FAULT_SA0 or FAULT_SA1
+ *  \param cube If not NULL, a test cube to extend (one value per PI, in Netlist::getPIs()
+ *  order). Its 0 and 1 values are assigned first and never changed; PODEM only decides on
+ *  the PIs that are X in the cube. Used for dynamic compaction.
+ *  \return PODEM_DETECTED if a test was found (see \a getTest()), PODEM_UNDETECTABLE if the
+ *  fault was proven undetectable (within the cube, if one is given), or PODEM_ABORTED if a
+ *  backtrack or time limit was reached.
+ */
+int PodemWorker::run(int g, char type, const vector<char>* cube) {
+	faultGate = g;
+	faultType = type;
+	values.assign(values.size(), LOGIC_X);
+	dFrontier.clear();
+	decisions.clear();
+	kept.clear();
+	trail.clear();
+	generator.seed(2*g + type);
+	numFaults++;
+
+	// The cube's values are below every decision on the trail, so they are never undone.
+	if (cube != NULL) {
+		const vector<int>& pi = netlist->getPIs();
+		for (int i=0; i<pi.size(); i++)
+			if (((*cube)[i] == LOGIC_ZERO) || ((*cube)[i] == LOGIC_ONE))
+				assign(pi[i], (*cube)[i]);
+	}
+
+	long backtracks = 0;
+	long numDecisions = 0;
+	start = chrono::steady_clock::now();
+	while (true) {
+		// a new level of the search
+		if (faultAtPO())
+			return PODEM_DETECTED;
+
+		// the clock is read every 64 decisions, to keep it cheap
+		if ((timeLimit > 0) && ((++numDecisions & 63) == 0) &&
+		    (chrono::duration<double>(chrono::steady_clock::now() - start).count() > timeLimit))
+			return PODEM_ABORTED;
+
+		int objGate;
+		char objVal;
+		bool found = (mode == 6) ? getSCOAPObjective(objGate, objVal) : getObjective(objGate, objVal);
+		if (found) {
+			char piVal;
+			int pi = (mode == 6) ? scoapBacktrace(objGate, objVal, piVal) : backtrace(objGate, objVal, piVal);
+			decision d = {pi, piVal, false, (int)trail.size()};
+			decisions.push_back(d);
+			assign(pi, piVal);
+			continue;
+		}
+
+		// This level failed: go back up to the first decision whose opposite value is untried.
+		while (true) {
+			if (decisions.empty())
+				return PODEM_UNDETECTABLE;
+			decision& top = decisions.back();
+			if (!top.flipped) {
+				// a PI with the fault only gets one try, and keeps its value
+				if (top.pi == faultGate) {
+					kept.push_back(top);
+					decisions.pop_back();
+					continue;
+				}
+				if ((backtrackLimit > 0) && (++backtracks > backtrackLimit))
+					return PODEM_ABORTED;
+				top.flipped = true;
+				int pi = top.pi;
+				char val = (top.val == LOGIC_ONE) ? LOGIC_ZERO : LOGIC_ONE;
+				undo(top.trailMark);
+				assign(pi, val);
+				break;
+			}
+			// both values failed: the PI goes back to X
+			int mark = top.trailMark;
+			decisions.pop_back();
+			undo(mark);
+		}
+	}
+}
+
+/** \brief Gives the test found by the last call to \a run().
+ *  \param test Set to the value of each PI, in Netlist::getPIs() order. A PI may be LOGIC_X,
+ *  or LOGIC_D or LOGIC_DBAR if it has the fault.
+ */
+void PodemWorker::getTest(vector<char>& test) const {
+	const vector<int>& pi = netlist->getPIs();
+	test.resize(pi.size());
+	for (int i=0; i<pi.size(); i++)
+		test[i] = values[pi[i]];
+}
+
+/** \brief Private function: the SCOAP controllability of gate \a g to value \a v (CC1 for LOGIC_ONE, CC0 otherwise). */
+int PodemWorker::controllability(int g, char v) const {
+	const scoapStruct& s = netlist->getSCOAP(g);
+	return (v == LOGIC_ONE) ? s.cc1 : s.cc0;
+}
+
+/** \brief Private function: true if a PO has the value D or D'. */
+bool PodemWorker::faultAtPO() const {
+	const vector<int>& po = netlist->getPOs();
+	for (int i=0; i<po.size(); i++)
+		if ((values[po[i]] == LOGIC_D) || (values[po[i]] == LOGIC_DBAR))
+			return true;
+	return false;
+}
+
+/** \brief Private function: the PODEM objective in modes 1 through 5.
+ *  \param g Set to the objective gate
+ *  \param v Set to the objective value
+ *  \return False if there is no objective: the fault cannot be activated any more, or its
+ *  effect cannot be propagated any further.
+ */
+bool PodemWorker::getObjective(int& g, char& v) {
+	char faultValue = values[faultGate];
+	if ((faultValue == LOGIC_ZERO) || (faultValue == LOGIC_ONE))
+		return false;
+	if (faultValue == LOGIC_X) {
+		g = faultGate;
+		v = (faultType == FAULT_SA0) ? LOGIC_ONE : LOGIC_ZERO;
+		return true;
+	}
+
+	// The fault is activated: set an X input of a D-frontier gate to its non-controlling value
+	// (XOR is treated as OR, and XNOR as NOR).
+	if (dFrontier.size() == 0)
+		return false;
+	int dGate;
+	if (mode < 4)
+		dGate = dFrontier.first();
+	else
+		dGate = dFrontier.get(generator() % dFrontier.size());
+	char t = netlist->getType(dGate);
+	v = ((t == GATE_AND) || (t == GATE_NAND)) ? LOGIC_ONE : LOGIC_ZERO;
+	for (int k=netlist->faninBegin(dGate); k<netlist->faninEnd(dGate); k++) {
+		int in = netlist->faninAt(k);
+		if (isX(in)) {
+			g = in;
+			return true;
+		}
+	}
+	return false;
+}
+
+/** \brief Private function: the PODEM objective in mode 6, guided by SCOAP.
+ *  \param g Set to the objective gate
+ *  \param v Set to the objective value
+ *  \return False if there is no objective, as for \a getObjective().
+ *
+ * Activating the fault is as in the other modes, but only while the fault site still has an
+ * X-path to a PO (see \a hasXPath()). Then, of the D-frontier gates with an X-path, the one
+ * closest to a PO (minimum CO) is picked. All of that gate's X inputs need the non-controlling
+ * value, so the hardest one to set (maximum CC) is taken, so that a conflict is found as early
+ * as possible. Any known value on the other inputs of an XOR or XNOR lets the fault effect
+ * through, so there the input and value that are easiest to set are taken.
+ *
+ * The X-path checks end a branch of the search as soon as the fault effect cannot reach a PO;
+ * without them, proving the fault undetectable below a decision needs every PI decision under
+ * it to be tried.
+ */
+bool PodemWorker::getSCOAPObjective(int& g, char& v) {
+	char faultValue = values[faultGate];
+	if ((faultValue == LOGIC_ZERO) || (faultValue == LOGIC_ONE))
+		return false;
+	if ((faultValue == LOGIC_X) && !hasXPath(faultGate))
+		return false;
+	if (faultValue == LOGIC_X) {
+		g = faultGate;
+		v = (faultType == FAULT_SA0) ? LOGIC_ONE : LOGIC_ZERO;
+		return true;
+	}
+	if (dFrontier.size() == 0)
+		return false;
+
+	int dGate = minObservabilityGate();
+	if (dGate < 0)
+		return false;
+	char t = netlist->getType(dGate);
+	if ((t == GATE_XOR) || (t == GATE_XNOR)) {
+		int best = -1, bestCost = 0;
+		for (int k=netlist->faninBegin(dGate); k<netlist->faninEnd(dGate); k++) {
+			int in = netlist->faninAt(k);
+			if (!isX(in))
+				continue;
+			const scoapStruct& s = netlist->getSCOAP(in);
+			int cost = min(s.cc0, s.cc1);
+			if ((best < 0) || (cost < bestCost)) {
+				best = in;
+				bestCost = cost;
+				v = (s.cc0 <= s.cc1) ? LOGIC_ZERO : LOGIC_ONE;
+			}
+		}
+		g = best;
+		return best >= 0;
+	}
+
+	v = ((t == GATE_AND) || (t == GATE_NAND)) ? LOGIC_ONE : LOGIC_ZERO;
+	g = hardestInput(dGate, v);
+	return g >= 0;
+}
+
+/** \brief Private function: the D-frontier gate with the smallest CO that has an X-path to a PO, or -1 if none has.
+ *  Ties go to the smallest gate ID, so the choice does not depend on the order of the
+ *  D-frontier. A gate with no CO (it reaches no PO) is never preferred.
+ */
+int PodemWorker::minObservabilityGate() {
+	int best = -1;
+	for (int i=0; i<dFrontier.size(); i++) {
+		int g = dFrontier.get(i);
+		int co = netlist->getSCOAP(g).co;
+		if (best >= 0) {
+			int bestCO = netlist->getSCOAP(best).co;
+			if (co == CC_UNSET)
+				continue;
+			if ((bestCO != CC_UNSET) && ((co > bestCO) || ((co == bestCO) && (g > best))))
+				continue;
+		}
+		if (hasXPath(g))
+			best = g;
+	}
+	return best;
+}
+
+/** \brief Private function: true if D-frontier gate \a g has an X-path: a path of gates at X from its output to a PO.
+ *  Without one, the fault effect cannot get through \a g, whatever the PIs that are still X are set to.
+ */
+bool PodemWorker::hasXPath(int g) {
+	xPathStamp++;
+	xPathStack.clear();
+	xPathStack.push_back(g);
+	xPathMark[g] = xPathStamp;
+	while (!xPathStack.empty()) {
+		int h = xPathStack.back();
+		xPathStack.pop_back();
+		if (isPO[h])
+			return true;
+		for (int k=netlist->fanoutBegin(h); k<netlist->fanoutEnd(h); k++) {
+			int out = netlist->fanoutAt(k);
+			if ((xPathMark[out] != xPathStamp) && isX(out)) {
+				xPathMark[out] = xPathStamp;
+				xPathStack.push_back(out);
+			}
+		}
+	}
+	return false;
+}
+
+/** \brief Private function: the PODEM backtrace in modes 1 through 5.
+ *  \param objGate The objective gate
+ *  \param objVal The objective value
+ *  \param piVal Set to the value for the PI
+ *  \return The ID of the PI to set, found by following the first X input of each gate.
+ */
+int PodemWorker::backtrace(int objGate, char objVal, char& piVal) const {
+	int g = objGate;
+	int numInversions = 0;
+	while (netlist->getType(g) != GATE_PI) {
+		char t = netlist->getType(g);
+		if ((t == GATE_NOT) || (t == GATE_NOR) || (t == GATE_NAND) || (t == GATE_XNOR))
+			numInversions++;
+		for (int k=netlist->faninBegin(g); k<netlist->faninEnd(g); k++) {
+			if (values[netlist->faninAt(k)] == LOGIC_X) {
+				g = netlist->faninAt(k);
+				break;
+			}
+		}
+	}
+
+	if (numInversions % 2 == 0)
+		piVal = objVal;
+	else
+		piVal = (objVal == LOGIC_ZERO) ? LOGIC_ONE : LOGIC_ZERO;
+	return g;
+}
+
+/** \brief Private function: the PODEM backtrace in mode 6, guided by SCOAP.
+ *  \param objGate The objective gate
+ *  \param objVal The objective value
+ *  \param piVal Set to the value for the PI
+ *  \return The ID of the PI to set.
+ *
+ * The value needed is carried back through each gate. If one input with the controlling
+ * value sets the output, the easiest X input to set (minimum CC) is followed; if all inputs
+ * need the non-controlling value, the hardest (maximum CC), to fail early. XOR and XNOR gates
+ * are followed by parity (see \a parityInput()).
+ */
+int PodemWorker::scoapBacktrace(int objGate, char objVal, char& piVal) const {
+	int g = objGate;
+	char v = objVal;
+	while (netlist->getType(g) != GATE_PI) {
+		char t = netlist->getType(g);
+		if ((t == GATE_NOT) || (t == GATE_NOR) || (t == GATE_NAND) || (t == GATE_XNOR))
+			v = (v == LOGIC_ZERO) ? LOGIC_ONE : LOGIC_ZERO;
+		int next;
+		if ((t == GATE_XOR) || (t == GATE_XNOR))
+			next = parityInput(g, v);
+		else {
+			bool allInputs = false;
+			if ((t == GATE_AND) || (t == GATE_NAND))
+				allInputs = (v == LOGIC_ONE);
+			else if ((t == GATE_OR) || (t == GATE_NOR))
+				allInputs = (v == LOGIC_ZERO);
+			next = allInputs ? hardestInput(g, v) : easiestInput(g, v);
+		}
+		assert(next >= 0);
+		g = next;
+	}
+	piVal = v;
+	return g;
+}
+
+/** \brief Private function: the X input of gate \a g with the largest controllability to \a v, or -1 if there is none. */
+int PodemWorker::hardestInput(int g, char v) const {
+	int best = -1, bestCC = -1;
+	for (int k=netlist->faninBegin(g); k<netlist->faninEnd(g); k++) {
+		int in = netlist->faninAt(k);
+		if (isX(in) && (controllability(in, v) > bestCC)) {
+			best = in;
+			bestCC = controllability(in, v);
+		}
+	}
+	return best;
+}
+
+/** \brief Private function: the X input of gate \a g with the smallest controllability to \a v, or -1 if there is none. */
+int PodemWorker::easiestInput(int g, char v) const {
+	int best = -1;
+	for (int k=netlist->faninBegin(g); k<netlist->faninEnd(g); k++) {
+		int in = netlist->faninAt(k);
+		if (isX(in) && ((best < 0) || (controllability(in, v) < controllability(best, v))))
+			best = in;
+	}
+	return best;
+}
+
+/** \brief Private function: parity-aware backtrace through an XOR gate \a g of any width.
+ *  \param v The output value needed (for XNOR, already inverted); set to the value the returned input needs
+ *  \return The input to follow, or -1 if no input is X.
+ *
+ * The known inputs fix part of the parity (D counts as its good value 1, D' as 0). If only
+ * one X input is left, it must supply the rest of the parity. Otherwise the other X inputs can
+ * still change the parity whatever this one gets, so SCOAP cannot say which choice is cheaper:
+ * the first X input is followed with the value needed unchanged, as in \a backtrace(). (Taking
+ * the input and value with the smallest CC instead took 7.7M implications on c432.bigfault, and
+ * this 5.6M.)
+ */
+int PodemWorker::parityInput(int g, char& v) const {
+	int parity = (v == LOGIC_ONE);
+	int numX = 0;
+	int first = -1;
+	for (int k=netlist->faninBegin(g); k<netlist->faninEnd(g); k++) {
+		int in = netlist->faninAt(k);
+		if (isX(in)) {
+			numX++;
+			if (first < 0)
+				first = in;
+		}
+		else if ((values[in] == LOGIC_ONE) || (values[in] == LOGIC_D))
+			parity ^= 1;
+	}
+	if (numX == 1)
+		v = parity ? LOGIC_ONE : LOGIC_ZERO;
+	return first;
+}
+
+/** \brief Private function: sets a PI to a value and implies it, recording the changes on the trail. */
+void PodemWorker::assign(int pi, char v) {
+	trailEntry change = {pi, values[pi]};
+	trail.push_back(change);
+	values[pi] = v;
+	imply(pi);
+}
+
+/** \brief Private function: simulates a change on a PI, recording every value change on the trail.
+ *  \param pi The PI whose value was just set
+ *  In mode 1 the whole circuit is simulated (see \a simulateFull()). Otherwise the simulation
+ *  is event-driven: only the fanout of gates whose value changed is evaluated, in level order.
+ */
+void PodemWorker::imply(int pi) {
+	numImplications++;
+	if (pi == faultGate) {
+		char v = Netlist::injectFault(faultType, values[pi]);
+		if (v != values[pi]) {
+			trailEntry change = {pi, values[pi]};
+			trail.push_back(change);
+			values[pi] = v;
+		}
+	}
+	if (mode == 1) {
+		simulateFull();
+		return;
+	}
+
+	dFrontier.update(pi);
+	for (int k=netlist->fanoutBegin(pi); k<netlist->fanoutEnd(pi); k++)
+		events.push(netlist->fanoutAt(k));
+
+	int g;
+	while ((g = events.pop()) >= 0) {
+		numEvaluations++;
+		char v = netlist->evaluate(g, &values[0]);
+		if (g == faultGate)
+			v = Netlist::injectFault(faultType, v);
+		if (v == values[g])
+			continue;
+
+		trailEntry change = {g, values[g]};
+		trail.push_back(change);
+		values[g] = v;
+		dFrontier.update(g);
+		for (int k=netlist->fanoutBegin(g); k<netlist->fanoutEnd(g); k++)
+			events.push(netlist->fanoutAt(k));
+	}
+}
+
+/** \brief Private function: full-circuit simulation (mode 1).
+ *  Every gate but the PIs is evaluated, in one sweep in level order, so its inputs are set
+ *  before it is evaluated. The D-frontier is then recomputed from scratch.
+ */
+void PodemWorker::simulateFull() {
+	const vector<int>& order = netlist->getLevelOrder();
+	for (int i=0; i<order.size(); i++) {
+		int g = order[i];
+		if (netlist->getType(g) == GATE_PI)
+			continue;
+		numEvaluations++;
+		char v = netlist->evaluate(g, &values[0]);
+		if (g == faultGate)
+			v = Netlist::injectFault(faultType, v);
+		if (v == values[g])
+			continue;
+		trailEntry change = {g, values[g]};
+		trail.push_back(change);
+		values[g] = v;
+	}
+	dFrontier.rebuild();
+}
+
+/** \brief Private function: restores the values from before the trail had \a mark entries.
+ *  No gates are evaluated. Kept decisions that were undone are assigned again.
+ */
+void PodemWorker::undo(int mark) {
+	while (trail.size() > mark) {
+		values[trail.back().gate] = trail.back().value;
+		dFrontier.update(trail.back().gate);
+		trail.pop_back();
+	}
+	numUndos++;
+
+	for (int i=0; i<kept.size(); i++) {
+		if (kept[i].trailMark >= mark) {
+			kept[i].trailMark = trail.size();
+			assign(kept[i].pi, kept[i].val);
+		}
+	}
+}
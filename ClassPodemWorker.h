@@ -0,0 +1,87 @@
+#ifndef CLASSPODEMWORKER_H
+#define CLASSPODEMWORKER_H
+
+#include "ClassNetlist.h"
+#include "ClassDFrontier.h"
+#include "ClassLevelQueue.h"
+#include <vector>    // vector
+#include <chrono>    // steady_clock
+#include <random>    // mt19937
+
+// Results of PodemWorker::run()
+#define PODEM_DETECTED 0
+#define PODEM_UNDETECTABLE 1
+#define PODEM_ABORTED 2
+
+class PodemWorker{
+
+ private:
+	Netlist* netlist;             // only its structure (and SCOAP numbers) is used; its values are never read or changed
+	int mode;                     // the program's mode, which selects the heuristics (see the class description)
+
+	vector<char> values;          // this worker's value of each gate
+	int faultGate;                // the gate with the fault being targeted
+	char faultType;               // FAULT_SA0 or FAULT_SA1
+
+	DFrontier dFrontier;          // follows values
+	LevelQueue events;            // gates waiting to be evaluated by imply()
+	mt19937 generator;            // picks the D-frontier gate in modes 4 and 5; seeded from the fault in run()
+
+	vector<char> isPO;            // 1 for each gate that drives a PO
+	vector<int> xPathMark;        // gates visited by hasXPath(), marked with xPathStamp
+	vector<int> xPathStack;       // hasXPath()'s search stack
+	int xPathStamp;
+
+	// One level of the search: a PI decision, and whether its opposite value has been tried
+	struct decision {
+		int pi;
+		char val;
+		bool flipped;
+		int trailMark;            // size of trail before this decision was implied
+	};
+	vector<decision> decisions;   // the decision stack
+	vector<decision> kept;        // failed decisions on a faulty PI, which keep their value
+
+	// One entry of the value trail: a gate and the value it had before a change
+	struct trailEntry {
+		int gate;
+		char value;
+	};
+	vector<trailEntry> trail;
+
+	long backtrackLimit;          // 0 means no limit
+	double timeLimit;             // in seconds; 0 means no limit
+	chrono::steady_clock::time_point start;
+
+	long long numFaults, numImplications, numUndos, numEvaluations;
+
+	bool isX(int g) const { return (values[g] == LOGIC_X) || (values[g] == LOGIC_UNSET); }
+	int controllability(int g, char v) const;
+	bool faultAtPO() const;
+	bool getObjective(int& g, char& v);
+	bool getSCOAPObjective(int& g, char& v);
+	int minObservabilityGate();
+	bool hasXPath(int g);
+	int backtrace(int objGate, char objVal, char& piVal) const;
+	int scoapBacktrace(int objGate, char objVal, char& piVal) const;
+	int hardestInput(int g, char v) const;
+	int easiestInput(int g, char v) const;
+	int parityInput(int g, char& v) const;
+	void assign(int pi, char v);
+	void imply(int pi);
+	void simulateFull();
+	void undo(int mark);
+
+ public:
+	PodemWorker(Netlist* nl, int mode, long backtracks = 0, double seconds = 0);
+
+	int run(int g, char type, const vector<char>* cube = NULL);
+	void getTest(vector<char>& test) const;
+
+	long long getNumberFaults() const { return numFaults; }
+	long long getNumberImplications() const { return numImplications; }
+	long long getNumberUndos() const { return numUndos; }
+	long long getNumberEvaluations() const { return numEvaluations; }
+};
+
+#endif
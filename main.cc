@@ -51,11 +51,21 @@
 #include "ClassCircuit.h"
 #include "ClassGate.h"
 #include "ClassFaultEquiv.h"
+#include "ClassPatternSim.h"
+#include "ClassFaultSim.h"
+#include "ClassPodemPool.h"
+#include "ClassCompiledSim.h"
+#include "ClassNetlistCache.h"
 #include <limits>
 #include <stdlib.h>
 #include <time.h>
 #include <ctime>
+#include <chrono>
+#include <thread>
+#include <random>
+#include <iomanip>
 #include <unordered_set>
+#include <unordered_map>
 
 using namespace std;
 
@@ -71,57 +81,35 @@ extern Circuit* myCircuit;
 //--------------------------
 // Helper functions
 void printUsage();
-bool checkTest(Circuit* myCircuit);
+bool checkTest(const vector<char>& test, faultStruct fault);
 string printPIValue(char v);
-void setValueCheckFault(Gate* g, char gateValue);
 //--------------------------
 
-//----------------------------
-// Functions for logic simulation
-void simFullCircuit(Circuit* myCircuit);
-void eventDrivenSim(Circuit* myCircuit, queue<Gate*> q);
-//----------------------------
-
 //----------------------------
 // Functions for PODEM:
-bool podemRecursion(Circuit* myCircuit);
-bool getObjective(Gate* &g, char &v, Circuit* myCircuit);
-void updateDFrontier(Circuit* myCircuit);
-void backtrace(Gate* &pi, char &piVal, Gate* objGate, char objVal, Circuit* myCircuit);
-bool d_dbar_on_PO(Circuit*);
-void printPODEMResult(bool, Circuit*, vector<faultStruct>&, vector<vector<char>>&, ofstream&, char);
+bool parseOptions(int argc, char* argv[]);
+void reportPODEMResult(int, vector<char>&, faultStruct, vector<faultStruct>&, vector<vector<char>>&, ofstream&);
 void addDominatedNodesToSet(vector<faultEquivNode*>,unordered_set<faultEquivNode*>&);
-void runPODEMForNode(faultEquivNode*, Circuit*, vector<faultStruct>&, vector<vector<char>>&, ofstream&, unordered_set<faultEquivNode*>&, vector<faultEquivNode*>&);
+void runPODEMForNode(faultEquivNode*, Circuit*, vector<faultStruct>&, vector<vector<char>>&, ofstream&, unordered_set<faultEquivNode*>&, vector<faultEquivNode*>&, FaultSim&, PodemWorker&);
 void validateResultsFromATPG(Circuit*, vector<faultStruct>&, vector<vector<char>>&, vector<faultStruct>);
+void randomPatternPhase(Circuit*, vector<faultStruct>&, vector<vector<char>>&, ofstream&);
+void fillXValues(vector<char>&);
+void dropDetectedFaults(const vector<char>&, FaultSim&, vector<char>&, PodemPool*);
+void reportDroppedFault(faultStruct);
+int compactTest(vector<char>&, int, vector<faultStruct>&, vector<char>&, PodemWorker&, PodemPool*);
+void staticCompaction(Circuit*, vector<faultStruct>&, vector<vector<char>>&, string);
+void benchmarkKernels(Circuit*);
 //--------------------------
 
 //----------------------------
 // If you add functions, please add the prototypes here.
-void setGateOutputs(vector<Gate*>&);
-int findGateValue(vector<Gate*>&, int); 
-bool isControllingValue(int, int);
 int controllingOutput(int);
-int nonControllingOutput(int);
 int nonControllingValue(int);
-int handleExclusiveGates(vector<Gate*>&, int);
-int handleNot(vector<Gate*>&);
-int handleBuffFanout(vector<Gate*>&);
-void setValueForError(int, Gate*);
-void setPIFanouts(Circuit*);
-void setAllEquivalentNodes(vector<Gate*>&, FaultEquiv&);
+void setAllEquivalentNodes(GateView, FaultEquiv&);
 bool isValidEquivGate(Gate*);
 void setEquivForGate(Gate*, FaultEquiv&);
-void removeGateFromDFrontier(Gate*);
 void setSCOAPValues(Circuit*);
-void printSCOAPValues(vector<Gate*>);
-void setControlability(vector<Gate*>);
-void setObservability(vector<Gate*> outputs);
-void set_CC0_CC1(Gate*, vector<Gate*>);
-void set_CO(Gate*, vector<Gate*>);
-Gate* getGateWithMinObserv(vector<Gate*>);
-bool getInputWithMaxCC1(Gate* &, vector<Gate*>);
-bool getInputWithMaxCC0(Gate* &, vector<Gate*>);
-int randNum(int min, int max);
+void printSCOAPReport(Circuit*, ostream&);
 //-----------------------------
 
 
@@ -130,18 +118,72 @@ int randNum(int min, int max);
 // Global variables
 // These are made global to make your life slightly easier.
 
-/** Global variable: a vector of Gate pointers for storing the D-Frontier. */
-vector<Gate*> dFrontier;
+/** Global variable: number of gate evaluations done by the PODEM simulators (see PodemWorker). */
+long long simEvaluations = 0;
+
+/** Global variable: number of PI values implied by the PODEM simulators. */
+long long simImplications = 0;
+
+/** Global variable: number of PI values implied by PODEM (simulations run), over all faults. */
+long long podemImplications = 0;
 
-/** Global variable: holds a pointer to the gate with stuck-at fault on its output location. */
-Gate* faultLocation;     
+/** Global variable: number of decisions undone with the value trail, over all faults. */
+long long podemUndos = 0;
 
-/** Global variable: holds the logic value you will need to activate the stuck-at fault. */
-char faultActivationVal;
+/** Global variable: number of faults PODEM was run for. */
+long long podemFaults = 0;
+
+/** Global variable: the 64-pattern bit-parallel simulator used to check and reuse tests. */
+PatternSim* patternSim;
 
 /** Global variable: which part of the project are you running? */
 int mode = -1;
 
+/** Global variable: the faults PODEM gave up on (neither a test found nor proven undetectable). */
+vector<faultStruct> abortedFaults;
+
+/** Global variable: number of faults for which PODEM found a test. */
+int detectedCount = 0;
+
+/** Global variable: maximum number of backtracks per fault (option -b); 0 means no limit. */
+long backtrackLimit = 0;
+
+/** Global variable: maximum time in seconds spent per fault (option -t); 0 means no limit. */
+double timeLimit = 0;
+
+/** Global variable: number of threads running PODEM, in every mode but 5 (option -j). */
+int numThreads = 1;
+
+/** Global variable: fault simulate each test PODEM finds and drop the faults it detects (option -d). */
+bool dropDetected = false;
+
+/** Global variable: pack secondary faults into the X inputs of each test (option -c; implies -d). */
+bool compactTests = false;
+
+/** Global variable: maximum number of backtracks when targeting a secondary fault (option -c). */
+long secondaryBacktrackLimit = 50;
+
+/** Global variable: 1 to compact the final test set by merging and reverse-order fault simulation (option -s), 2 to also use a greedy set cover (option -g), 0 for neither. */
+int staticCompactionLevel = 0;
+
+/** Global variable: only write the SCOAP testability report to output_loc.scoap, and skip PODEM (option -p). */
+bool scoapReportOnly = false;
+
+/** Global variable: simulate the fault-free circuit with compiled code in the bit-parallel simulators (option -x). */
+bool useCompiledSim = false;
+
+/** Global variable: read the circuit from its netlist cache when it matches the bench file, and write the cache otherwise (option -n). */
+bool useNetlistCache = false;
+
+/** Global variable: only time the gate evaluation kernels on this circuit, and skip PODEM (option -k). */
+bool kernelBenchmarkOnly = false;
+
+/** Global variable: generates the values for the X inputs of tests (mode 5, options -d and -s); fixed seed, so runs are repeatable. */
+mt19937 fillGenerator(1);
+
+/** Global variable: the random-pattern phase stops when a batch detects less than this percentage of the faults (option -r); 0 means no random phase. */
+double randomThreshold = 0;
+
 
 /** @brief The main function.
  * 
@@ -152,30 +194,80 @@ int mode = -1;
 int main(int argc, char* argv[]) {
 
 	// Check the command line input and usage
-	if (argc != 5) {
+	if ((argc < 5) || !parseOptions(argc, argv)) {
 		printUsage();    
 		return 1;
 	}
 	
 	mode = atoi(argv[1]);
-	if ((mode < 1) || (mode > 5)) {
+	if ((mode < 1) || (mode > 6)) {
 		printUsage();    
 		return 1;   
 	}
 
-	// Parse the bench file and initialize the circuit.
-	FILE *benchFile = fopen(argv[2], "r");
-	if (benchFile == NULL) {
-		cout << "ERROR: Cannot read file " << argv[2] << " for input" << endl;
-		return 1;
+	// With -n, try the netlist cache first; it is only used if it was written from this exact bench file.
+	uint64_t benchChecksum = 0;
+	string netlistCacheFile;
+	bool fromCache = false;
+	if (useNetlistCache) {
+		if (!NetlistCache::checksumFile(argv[2], benchChecksum)) {
+			cout << "ERROR: Cannot read file " << argv[2] << " for input" << endl;
+			return 1;
+		}
+		netlistCacheFile = NetlistCache::fileFor(benchChecksum);
+		NetlistCache cache(netlistCacheFile, benchChecksum);
+		if (cache.isLoaded()) {
+			myCircuit->setupFromCache(cache);
+			fromCache = true;
+		}
 	}
-	yyin=benchFile;
-	yyparse();
-	fclose(benchFile);
 
-	myCircuit->setupCircuit(); 
+	if (!fromCache) {
+		// Parse the bench file and initialize the circuit.
+		FILE *benchFile = fopen(argv[2], "r");
+		if (benchFile == NULL) {
+			cout << "ERROR: Cannot read file " << argv[2] << " for input" << endl;
+			return 1;
+		}
+		yyin=benchFile;
+		yyparse();
+		fclose(benchFile);
+
+		myCircuit->setupCircuit(); 
+
+		if (useNetlistCache && !NetlistCache::write(netlistCacheFile, benchChecksum, myCircuit))
+			cout << "WARNING: Cannot write the netlist cache " << netlistCacheFile << endl;
+	}
+	patternSim = new PatternSim(myCircuit->getNetlist());
+	if (useCompiledSim) {
+		// Compiled (or loaded from the cache) once; every PatternSim and FaultSim then uses it.
+		CompiledSim* compiledSim = new CompiledSim(myCircuit->getNetlist());
+		if (compiledSim->isLoaded())
+			myCircuit->getNetlist()->setCompiledSim(compiledSim);
+	}
 	cout << endl;
 
+	// With -k, the kernel microbenchmark is all we do; the fault file is not read.
+	if (kernelBenchmarkOnly) {
+		benchmarkKernels(myCircuit);
+		return 0;
+	}
+
+	// With -p, the testability report is all we do; the fault file is not read.
+	if (scoapReportOnly) {
+		string dotSCOAPFile = argv[4];
+		dotSCOAPFile += ".scoap";
+		ofstream scoapStream(dotSCOAPFile);
+		if (!scoapStream.is_open()) {
+			cout << "ERROR: Cannot open file " << dotSCOAPFile << " for output" << endl;
+			return 1;
+		}
+		setSCOAPValues(myCircuit);
+		printSCOAPReport(myCircuit, scoapStream);
+		cout << "SCOAP testability report written to " << dotSCOAPFile << endl;
+		return 0;
+	}
+
 	// Setup the output text files
 	ofstream outputStream, equivStream;
 	string dotOutFile = argv[4];
@@ -316,7 +408,7 @@ int main(int argc, char* argv[]) {
 		// (This may or may not help, depending on how you choose to structure 
 		// your fault equivalence code.)
                 
-                vector<Gate*> myCircuitPOs = myCircuit->getPOGates();
+                GateView myCircuitPOs = myCircuit->getPOGates();
                 setAllEquivalentNodes(myCircuitPOs, myFaultEquivGraph);
                 
 		// end of your equivalence fault collapsing code
@@ -345,9 +437,14 @@ int main(int argc, char* argv[]) {
 		// (or maybe you will just include these optimizations inside of your
 		// main PODEM code, and you can remove this)
                 //setSCOAPValues(myCircuit);
-                //printSCOAPValues(myCircuit->getPOGates());
+                //printSCOAPReport(myCircuit, cout);
 
 	}
+	// Mode 6 is mode 3 with SCOAP guiding PODEM (see PodemWorker::getSCOAPObjective()).
+	// The SCOAP values are computed once here.
+	if (mode == 6) {
+		setSCOAPValues(myCircuit);
+	}
 	// ------------- PODEM code ----------------------------------
 	// This will run in all parts by default. 
 
@@ -359,59 +456,127 @@ int main(int argc, char* argv[]) {
 	// finds. You may want to use this in checking correctness of
 	// your program.
 	vector<vector<char>> allTests;
+
+	// The faults the compacted test set must still detect (options -s and -g).
+	vector<faultStruct> compactionFaults;
+	if (staticCompactionLevel > 0)
+		compactionFaults = faultList;
+
+	// With option -r, random patterns are fault simulated first, and PODEM only
+	// targets the faults none of them detects (not in mode 5, which picks its own
+	// faults).
+	if ((randomThreshold > 0) && (mode != 5))
+		randomPatternPhase(myCircuit, faultList, allTests, outputStream);
+
         if (mode == 5) {
 		// TODO
 		// Here you should start your code for mode 5, test set size reduction
 		vector<faultEquivNode*> faultEquivNodes = myFaultEquivGraph.getAllFaultEquivNodes();
 		int faultNodes = faultEquivNodes.size(); 
 		unordered_set<faultEquivNode*> nodesTraversed;
+		// Fault k of nodeFaultSim is the first fault of faultEquivNodes[k]
+		// (simulated one test at a time, so one word per gate is enough).
+		FaultSim nodeFaultSim(myCircuit->getNetlist(), PATTERNS_PER_WORD);
+		for (faultEquivNode* node:faultEquivNodes)
+			nodeFaultSim.addFault(node->equivFaults[0].loc->get_gateID(), node->equivFaults[0].val);
+		// The order of the faults depends on the earlier tests, so they are targeted one at a time.
+		PodemWorker podem(myCircuit->getNetlist(), mode, backtrackLimit, timeLimit);
 		for (int faultNum = 0; faultNum < faultNodes; faultNum++) {
 
 			faultEquivNode* equivNode = faultEquivNodes[faultNum];
 			if(nodesTraversed.find(equivNode) != nodesTraversed.end()) continue;
 			
-                        runPODEMForNode(equivNode, myCircuit, undetectableFaults, allTests, outputStream, nodesTraversed, faultEquivNodes);	
+                        runPODEMForNode(equivNode, myCircuit, undetectableFaults, allTests, outputStream, nodesTraversed, faultEquivNodes, nodeFaultSim, podem);	
 		}
 		cout << "Test set has been reduced to " << allTests.size() + undetectableFaults.size() << " tests" << endl;
 		//validateResultsFromATPG(myCircuit, origFaultList, allTests, undetectableFaults);
+		podemFaults += podem.getNumberFaults();
+		podemImplications += podem.getNumberImplications();
+		podemUndos += podem.getNumberUndos();
+		simImplications += podem.getNumberImplications();
+		simEvaluations += podem.getNumberEvaluations();
 
 	}else{
 
 		// This is the main loop that performs PODEM.
-		// It iterates over all faults in the faultList. For each one,
-		// it will set up the fault and call your podemRecursion() function.
-		// You should not have to change this, but you should understand how 
-		// it works.
+		// The faults are targeted in parallel: each thread of the PodemPool runs PODEM (see
+		// PodemWorker, whose heuristics depend on the mode) with its own values and state. The
+		// results are collected here in fault order, so the output files are the same for
+		// any number of threads. With one thread, the faults are targeted right here, in order.
+		// With more than one thread, the faults expected to be hard (by SCOAP: the cost of
+		// activating the fault plus the cost of observing it) are started first.
+		if (numThreads > 1)
+			setSCOAPValues(myCircuit);
+		PodemPool pool(myCircuit->getNetlist(), mode, numThreads, backtrackLimit, timeLimit);
 		for (int faultNum = 0; faultNum < faultList.size(); faultNum++) {
-
-			// Clear the old fault in your circuit, if any.
-			myCircuit->clearFaults();
-		 
-			// Set up the fault we are trying to detect
-			faultLocation  = faultList[faultNum].loc;
-			char faultType = faultList[faultNum].val;
-			faultLocation->set_faultType(faultType);      
-			faultActivationVal = (faultType == FAULT_SA0) ? LOGIC_ONE : LOGIC_ZERO;
-		 
-			// Set all gate values to X
-			for (int i=0; i < myCircuit->getNumberGates(); i++) {
-				myCircuit->getGate(i)->setValue(LOGIC_X);
+			Gate* loc = faultList[faultNum].loc;
+			int cost = 0;
+			if (numThreads > 1)
+				cost = ((faultList[faultNum].val == FAULT_SA0) ? loc->get_CC1() : loc->get_CC0()) + loc->get_CO();
+			pool.addFault(loc->get_gateID(), faultList[faultNum].val, cost);
+		}
+		pool.start();
+
+		// With option -d, fault k of dropSim is faultList[k]; see dropDetectedFaults().
+		// With option -c, the secondary faults are targeted here, one test at a time.
+		FaultSim dropSim(myCircuit->getNetlist(), PATTERNS_PER_WORD);
+		vector<char> dropped(faultList.size(), 0);
+		if (dropDetected)
+			for (int faultNum = 0; faultNum < faultList.size(); faultNum++)
+				dropSim.addFault(faultList[faultNum].loc->get_gateID(), faultList[faultNum].val);
+		PodemWorker compactor(myCircuit->getNetlist(), mode, secondaryBacktrackLimit, timeLimit);
+
+		vector<char> test;
+		for (int faultNum = 0; faultNum < faultList.size(); faultNum++) {
+			if (dropped[faultNum]) {
+				reportDroppedFault(faultList[faultNum]);
+				continue;
 			}
+			int res = pool.getResult(faultNum, test);
+			if (compactTests && (res == PODEM_DETECTED))
+				compactTest(test, faultNum, faultList, dropped, compactor, &pool);
+			if (dropDetected && (res == PODEM_DETECTED))
+				fillXValues(test);
+			reportPODEMResult(res, test, faultList[faultNum], undetectableFaults, allTests, outputStream);
+
+			if (dropDetected) {
+				dropSim.dropFault(faultNum);
+				if (res == PODEM_DETECTED)
+					dropDetectedFaults(allTests.back(), dropSim, dropped, &pool);
+			}
+		}
+		pool.finish();
 
-			// initialize the D frontier.
-			dFrontier.clear();
-		
-			// call PODEM recursion function
-			bool res = podemRecursion(myCircuit);
-
-			printPODEMResult(res, myCircuit, undetectableFaults, allTests, outputStream, faultType);
+		if (numThreads > 1) {
+			for (int w = 0; w < pool.getNumberThreads(); w++)
+				cout << "Thread " << w << ": " << pool.getNumberRun(w) << " faults, " << pool.getNumberSteals(w) << " steals, "
+				     << pool.getBusyTime(w) << " s busy, " << pool.getIdleTime(w) << " s idle" << endl;
 		}
+		podemFaults += pool.getNumberFaults();
+		podemImplications += pool.getNumberImplications();
+		podemUndos += pool.getNumberUndos();
+		simImplications += pool.getNumberImplications();
+		simEvaluations += pool.getNumberEvaluations();
         }
 	//validateResultsFromATPG(myCircuit, origFaultList, allTests, undetectableFaults);
 
 	// -----------End of Part 4 ---------------------------------
+
+	// Static compaction (options -s and -g): the compacted tests go to a separate file.
+	if (staticCompactionLevel > 0)
+		staticCompaction(myCircuit, compactionFaults, allTests, string(argv[4]) + ".cmp");
+
 	cout << "Total undetectable faults " << undetectableFaults.size() << endl;	
+	if (podemFaults > 0)
+		cout << "PODEM: " << podemImplications << " implications and " << podemUndos << " undos for " << podemFaults
+		     << " faults (" << (double)podemImplications / podemFaults << " implications per fault)" << endl;
+	if ((mode >= 2) && (simImplications > 0))
+		cout << "Event-driven simulation: " << simEvaluations << " gate evaluations for " << simImplications
+		     << " implications (" << (double)simEvaluations / simImplications << " per implication)" << endl;
+	cout << "Summary: " << detectedCount << " detected, " << undetectableFaults.size() << " redundant, "
+	     << abortedFaults.size() << " aborted" << endl;
         // clean up and close the output stream
+	delete patternSim;
 	delete myCircuit;
 	outputStream.close();
 
@@ -420,19 +585,24 @@ int main(int argc, char* argv[]) {
 
 
 
-void printPODEMResult(bool res, Circuit* myCircuit, vector<faultStruct>& undetectableFaults, vector<vector<char>>& allTests,
-                     ofstream& outputStream, char faultType){
+/** @brief Writes the result of PODEM for one fault to the output file and the screen.
+ *  \param status PODEM_DETECTED, PODEM_UNDETECTABLE or PODEM_ABORTED
+ *  \param piValues The test, one value per PI in Circuit::getPIGates() order (only used if detected)
+ *  \param fault The fault
+ *  The test is added to allTests, or the fault to undetectableFaults or abortedFaults.
+ */
+void reportPODEMResult(int status, vector<char>& piValues, faultStruct fault, vector<faultStruct>& undetectableFaults,
+                       vector<vector<char>>& allTests, ofstream& outputStream){
 	// If we succeed, print the test we found to the output file, and 
 	// store the test in the allTests vector.
-	if (res == true) {
-		vector<Gate*> piGates = myCircuit->getPIGates();
+	if (status == PODEM_DETECTED) {
 		vector<char> thisTest;
-		for (int i=0; i < piGates.size(); i++) {
+		for (int i=0; i < piValues.size(); i++) {
 			// Print PI value to output file
-			outputStream << printPIValue(piGates[i]->getValue());
+			outputStream << printPIValue(piValues[i]);
 
 			// Store PI value for later
-			char v = piGates[i]->getValue();
+			char v = piValues[i];
 			if (v == LOGIC_D)
 				v = LOGIC_ONE;
 			else if (v == LOGIC_DBAR)
@@ -445,6 +615,8 @@ void printPODEMResult(bool res, Circuit* myCircuit, vector<faultStruct>& undetec
 	}
 
 	// If we failed to find a test, print a message to the output file
+	else if (status == PODEM_ABORTED)
+		outputStream << "aborted" << endl;
 	else 
 		outputStream << "none found" << endl;
 	
@@ -453,8 +625,8 @@ void printPODEMResult(bool res, Circuit* myCircuit, vector<faultStruct>& undetec
 	// Of course, this assumes that your simulation code is correct.
 	// Comment this out when you are evaluating the runtime of your
 	// ATPG system because it will add extra time.
-	if (res == true) {
-		if (!checkTest(myCircuit)) {
+	if (status == PODEM_DETECTED) {
+		if (!checkTest(piValues, fault)) {
 			cout << "ERROR: PODEM returned true, but generated test does not detect this fault on PO." << endl;
 			//myCircuit->printAllGates(); // uncomment if you want to see what is going on here
 			assert(false);
@@ -463,13 +635,18 @@ void printPODEMResult(bool res, Circuit* myCircuit, vector<faultStruct>& undetec
 	
 	// Just printing to screen to let you monitor progress. You can comment this
 	// out if you like.
-	cout << "Fault = " << faultLocation->get_outputName() << " / " << (int)(faultType) << ";";
-	if (res == true) 
+	cout << "Fault = " << fault.loc->get_outputName() << " / " << (int)(fault.val) << ";";
+	if (status == PODEM_DETECTED) {
 		cout << " test found; " << endl;
+		detectedCount++;
+	}
+	else if (status == PODEM_ABORTED) {
+		cout << " aborted; " << endl;
+		abortedFaults.push_back(fault);
+	}
 	else {
 		cout << " no test found; " << endl;
-		faultStruct f = {faultLocation, faultType};
-		undetectableFaults.push_back(f);
+		undetectableFaults.push_back(fault);
 	}
 }
 
@@ -485,16 +662,48 @@ void printPODEMResult(bool res, Circuit* myCircuit, vector<faultStruct>& undetec
  * You don't need to touch this.
  */
 void printUsage() {
-	cout << "Usage: ./atpg [mode] [bench_file] [fault_file] [output_base]" << endl << endl;
-	cout << "   mode:        1 through 5" << endl;
+	cout << "Usage: ./atpg [mode] [bench_file] [fault_file] [output_base] [options]" << endl << endl;
+	cout << "   mode:        1 through 6 (6: as 3, guided by SCOAP, with X-path checks)" << endl;
 	cout << "   bench_file:  the target circuit in .bench format" << endl;
 	cout << "   fault_file:  faults to be considered" << endl;
 	cout << "   output_base: basename for output file" << endl;
+	cout << "   options:" << endl;
+	cout << "      -b N      give up on a fault after N backtracks (default: no limit)" << endl;
+	cout << "      -t SEC    give up on a fault after SEC seconds (default: no limit)" << endl;
+	cout << "      -j N      run PODEM on N threads, except in mode 5 (default: 1; 0: one per core)" << endl;
+	cout << "      -d        fault simulate each test PODEM finds (with its X inputs filled in)" << endl;
+	cout << "                and skip the other faults it detects (mode 5 always does this," << endl;
+	cout << "                with fault dominance). Off by default, unlike the usual ATPG" << endl;
+	cout << "                flow, so that output_loc.out keeps one line per fault, as the" << endl;
+	cout << "                reference outputs in test/ expect" << endl;
+	cout << "      -c        after each test is found, target more faults within its X inputs" << endl;
+	cout << "                (dynamic compaction; implies -d)" << endl;
+	cout << "      -s        compact the test set after PODEM (merge compatible tests, then" << endl;
+	cout << "                reverse-order fault simulation) and write it to output_loc.cmp" << endl;
+	cout << "      -g        as -s, then also a greedy set cover" << endl;
+	cout << "      -r PCT    before PODEM, fault simulate batches of random patterns until a batch" << endl;
+	cout << "                detects less than PCT percent of the faults (not in mode 5)" << endl;
+	cout << "      -p        only write the SCOAP testability report (CC0, CC1 and CO of" << endl;
+	cout << "                each gate) to output_loc.scoap; PODEM is not run" << endl;
+	cout << "      -k        only time each gate evaluation kernel this circuit uses against" << endl;
+	cout << "                the generic kernel for its gate type; PODEM is not run" << endl;
+	cout << "      -x        fault simulate (-r, -d, -c, -s, -g) with the fault-free circuit" << endl;
+	cout << "                compiled to native code with g++; the compiled code is cached" << endl;
+	cout << "                in $ATPG_CACHE_DIR (default: .atpg_cache) by netlist hash" << endl;
+	cout << "      -n        read the circuit from a binary netlist cache instead of parsing" << endl;
+	cout << "                bench_file, if one was written from a file with the same contents;" << endl;
+	cout << "                otherwise parse it and write the cache, named by a checksum of" << endl;
+	cout << "                bench_file, in $ATPG_CACHE_DIR (default: .atpg_cache)" << endl;
 	cout << endl;
 	cout << "   The system will generate a test pattern for each fault listed" << endl;
 	cout << "   in fault_file and store the result in output_loc.out" << endl;
 	cout << "   If you are running Part 3 or 4, it will also print the result" << endl;
-	cout << "   of your equivalence fault collapsing in file output_loc.fc" << endl << endl;
+	cout << "   of your equivalence fault collapsing in file output_loc.fc" << endl;
+	cout << "   A fault PODEM gives up on because of -b or -t is reported as \"aborted\"" << endl;
+	cout << "   instead of \"none found\". With -r, output_loc.out starts with the random" << endl;
+	cout << "   patterns that were kept, and PODEM results follow only for the faults" << endl;
+	cout << "   those patterns do not detect. With -d (and -c), output_loc.out no longer" << endl;
+	cout << "   has one line per fault: a fault an earlier test detects gets no line." << endl << endl;
 	cout << "   Example: ./atpg 3 test/c17.bench test/c17.fault myc17" << endl;
 	cout << "      --> This will run your Part 3 code and produce two output files:" << endl;
 	cout << "          1: myc17.out - contains the test vectors you generated for these faults" << endl;
@@ -504,34 +713,79 @@ void printUsage() {
 }
 
 
-/** @brief Uses *your* simulator to check validity of your test.
+/** @brief Parses the options that follow the four required arguments.
+ *  \param argc The argument count from main()
+ *  \param argv The arguments from main()
+ *  \return False if an option is unknown or has a bad value.
+ */
+bool parseOptions(int argc, char* argv[]) {
+	for (int i=5; i<argc; i++) {
+		string opt = argv[i];
+		if ((opt == "-b") && (i+1 < argc)) {
+			backtrackLimit = atol(argv[++i]);
+			if (backtrackLimit <= 0)
+				return false;
+		}
+		else if ((opt == "-t") && (i+1 < argc)) {
+			timeLimit = atof(argv[++i]);
+			if (timeLimit <= 0)
+				return false;
+		}
+		else if ((opt == "-r") && (i+1 < argc)) {
+			randomThreshold = atof(argv[++i]);
+			if (randomThreshold <= 0)
+				return false;
+		}
+		else if (opt == "-d")
+			dropDetected = true;
+		else if (opt == "-p")
+			scoapReportOnly = true;
+		else if (opt == "-k")
+			kernelBenchmarkOnly = true;
+		else if (opt == "-x")
+			useCompiledSim = true;
+		else if (opt == "-n")
+			useNetlistCache = true;
+		else if (opt == "-s")
+			staticCompactionLevel = max(staticCompactionLevel, 1);
+		else if (opt == "-g")
+			staticCompactionLevel = 2;
+		else if (opt == "-c") {
+			compactTests = true;
+			dropDetected = true;
+		}
+		else if ((opt == "-j") && (i+1 < argc)) {
+			numThreads = atoi(argv[++i]);
+			if (numThreads == 0)
+				numThreads = max(1u, thread::hardware_concurrency());
+			if (numThreads < 0)
+				return false;
+		}
+		else
+			return false;
+	}
+	return true;
+}
+
+/** @brief Uses the bit-parallel simulator to check validity of your test.
  * 
  * This function can be called after your PODEM algorithm finishes.
- * If you enable this, it will clear the circuit's internal values,
- * and re-simulate the vector PODEM found to test your result.
+ * It takes the PI values PODEM found (test), and simulates them with the
+ * PatternSim (independently of the 5-valued simulator PODEM itself uses)
+ * to check that the fault is detected on some PO.
+ * The circuit's own values are not changed.
  
  * This is helpful when you are developing and debugging, but will just
  * slow things down once you know things are correct.
- 
- * Important: this function of course assumes that your simulation code 
- * is correct. If your simulation code is incorrect, then this is not
- * helpful to you.
 */
-bool checkTest(Circuit* myCircuit) {
-
-	simFullCircuit(myCircuit);
+bool checkTest(const vector<char>& test, faultStruct fault) {
 
-	// look for D or D' on an output
-	vector<Gate*> poGates = myCircuit->getPOGates();
-	for (int i=0; i<poGates.size(); i++) {
-		char v = poGates[i]->getValue();
-		if ((v == LOGIC_D) || (v == LOGIC_DBAR)) {
-			return true;
-		}
-	}
+	patternSim->clearPatterns();
+	patternSim->setPattern(0, test);
+	patternSim->simulateGood();
 
-	// If we didn't find D or D' on any PO, then our test was not successful.
-	return false;
+	// If the fault-free and faulty values differ on no PO, then our test was not successful.
+	return patternSim->simulateFault(fault.loc->get_gateID(), fault.val);
 
 }
 
@@ -552,572 +806,37 @@ string printPIValue(char v) {
 	return "";
 }
 
-/** @brief Set the value of Gate* g to value gateValue, accounting for any fault on g.
-		\note You will not need to modify this.
- */
-void setValueCheckFault(Gate* g, char gateValue) {
-	if ((g->get_faultType() == FAULT_SA0) && (gateValue == LOGIC_ONE)) 
-		g->setValue(LOGIC_D);
-	else if ((g->get_faultType() == FAULT_SA0) && (gateValue == LOGIC_DBAR)) 
-		g->setValue(LOGIC_ZERO);
-	else if ((g->get_faultType() == FAULT_SA1) && (gateValue == LOGIC_ZERO)) 
-		g->setValue(LOGIC_DBAR);
-	else if ((g->get_faultType() == FAULT_SA1) && (gateValue == LOGIC_D)) 
-		g->setValue(LOGIC_ONE);
-	else
-		g->setValue(gateValue);
-}
-
 // end of helper functions
 //////////////////////////////////////////////////////////////////////
 
-//////////////////////////////////////////////////////////////////////
-// Start of functions for circuit simulation.
-
-/** @brief Runs full circuit simulation
- *
- * Adapt your Project 2 code for this!
- */
-void simFullCircuit(Circuit* myCircuit) {
-
-	// Clear all the non-PI gate values
-	for (int i=0; i<myCircuit->getNumberGates(); i++) {
-		Gate* g = myCircuit->getGate(i);
-		if (g->get_gateType() != GATE_PI)
-			g->setValue(LOGIC_UNSET);      
-	}  
-
-	// TODO
-	// Write your simulation code here. Use your Project 2 code.
-	// Also: don't forget to check for faults on the PIs; you either
-	// need to do this here *or* in the PODEM recursion when you set
-	// the value.
-        
-        vector<Gate*> circuitPIs = myCircuit->getPIGates();
-        for(Gate* g:circuitPIs){
-          if(g->getValue() == LOGIC_UNSET) g->setValue(LOGIC_X);
-          else{
-            if(g->get_faultType() == FAULT_SA0 && g->getValue() == LOGIC_ONE) g->setValue(LOGIC_D);
-            if(g->get_faultType() == FAULT_SA1 && g->getValue() == LOGIC_ZERO) g->setValue(LOGIC_DBAR);
-          }
-          //cout << "gate name : " << g->get_outputName() << " value :" << g->printValue() << endl;
-        }
-        vector<Gate*> circuitPOs = myCircuit->getPOGates();
-        setGateOutputs(circuitPOs);
-}
-
-/** @brief Perform event-driven simulation.
- * \note You will write this function in Part 2.
- * 
- * Please see the project handout for a description of what
- * we are doing here and why.
-
- * This function takes as input the Circuit* and a queue<Gate*>
- * indicating the remaining gates that need to be evaluated.
- */
-void eventDrivenSim(Circuit* myCircuit, queue<Gate*> q) {
-	
-        Gate* pi = q.front();
-        setValueForError(pi->getValue(), pi);
-        //cout << "input name " << pi->get_outputName() << " value " << pi->printValue() << endl;
-        while(!q.empty()){
-          Gate* input = q.front();
-          q.pop();
-          vector<Gate*> outputs = input->get_gateOutputs();
-          vector<char> outputValues;
-          for(Gate* gate:outputs){
-            //cout << "output name " << gate->get_outputName() << " value " << gate->printValue() << endl;
-            outputValues.push_back(gate->getValue());
-            gate->setValue(LOGIC_UNSET);
-          }
-          setGateOutputs(outputs);
-          int i = 0;
-          for(Gate* outGate:outputs){
-            if(outputValues[i] != outGate->getValue()) q.push(outGate);
-            if(mode >= 4){
-              char inputValue = input->getValue(), outputValue = outGate->getValue();
-              if((inputValue == LOGIC_D || inputValue == LOGIC_DBAR) && outputValue == LOGIC_X)
-                dFrontier.push_back(outGate);
-              if((outputValue == LOGIC_D || outputValue == LOGIC_DBAR)){
-                removeGateFromDFrontier(outGate);
-              }
-            }
-            i++;
-          }
-        }
-}
-
-// End of functions for circuit simulation
-////////////////////////////////////////////////////////////
-
-
-/////////////////////////////////////////////////////////
-// Begin functions for PODEM.
-
-/** @brief PODEM recursion.
- *
- * \note For Part 1, you must write this, following the pseudocode from . 
- * Make use of the getObjective and backtrace functions.
- * For Part 2, you will add code to this that calls your eventDrivenSim() function.
- * For Parts 3 and 4, use the eventDrivenSim() version.
- */
-bool podemRecursion(Circuit* myCircuit) {
-
-	// TODO
-
-	// Write the PODEM recursion function here. It should:
-	//   - Check for D or D' on any PO and return true if so
-	//   - Call getObjective
-	//   - Call backtrace
-	//   - Set the PI indicated by your backtrace function.
-	//       - Be careful you are doing the right thing if there is a fault on a PI
-	//   - Recurse
-	//   - If recursion succeeds, return true.
-	//   - If recursion fails, reverse value you set on the PI and recurse again.
-  	//   - If recursion succeeds, return true.
-  	//   - If neither recursive call returns true, imply the PI = X and return false
-        //cout << "fault location name : " << faultLocation->get_outputName() << " value " << faultLocation->printValue();
-        if(d_dbar_on_PO(myCircuit)) return true;
-        Gate* target_gate = (Gate*)malloc(sizeof(Gate));
-        char gateVal = LOGIC_UNSET;
-        if(getObjective(target_gate, gateVal, myCircuit)){
-          if(!target_gate) return false;
-          Gate* input = (Gate*)malloc(sizeof(Gate));
-          char inputVal = LOGIC_UNSET;
-          backtrace(input, inputVal, target_gate, gateVal, myCircuit);
-          if(!input) return false;
-          
-          input->setValue(inputVal);
-          //Imply function based on the mode 
-          if(mode == 1){
-            simFullCircuit(myCircuit);
-          }else{
-            queue<Gate*> q;
-            q.push(input);
-            eventDrivenSim(myCircuit, q);
-          } 
-          //recurse
-          bool result = podemRecursion(myCircuit);
-          if(result) return true;
-          if(input->get_faultType() != NOFAULT) return false;
-          
-          //set opposite value if recursion fails
-          if(inputVal == LOGIC_ONE){
-            input->setValue(LOGIC_ZERO);
-          }else if(inputVal == LOGIC_ZERO){
-            input->setValue(LOGIC_ONE);
-          } 
-          //Impy function based on the mode
-          if(mode == 1){
-            simFullCircuit(myCircuit);
-          }else{
-            queue<Gate*> q;
-            q.push(input);
-            eventDrivenSim(myCircuit, q);
-          }
-          //recurse
-          result = podemRecursion(myCircuit);
-          if(result) return true;
-          
-          //IF both fail set PI value as X and retun false 
-          input->setValue(LOGIC_X);
-          if(mode == 1){
-            simFullCircuit(myCircuit);
-          }else{
-            queue<Gate*> q;
-            q.push(input);
-            eventDrivenSim(myCircuit, q);
-          } 
-          return false; 
-        }
-        return false;
-}
-
-// Find the objective for myCircuit. The objective is stored in g, v.
-// 
-// class or your textbook.
-/** @brief PODEM objective function.
- *  \param g Use this pointer to store the objective Gate your function picks.
- *  \param v Use this char to store the objective value your function picks.
- *  \param myCircuit A pointer to the Circuit being considered
- *  \returns True if the function is able to determine an objective, and false if it fails.
- * \note For Part 1, you must write this, following the pseudocode in class and the code's comments.
- */
-bool getObjective(Gate* &g, char &v, Circuit* myCircuit) {
-
-	// TODO
-
-	// Note: you have a global variable Gate* faultLocation which represents
-	// the gate with the fault. Use this when you need to check if the 
-	// fault has been excited yet.
-
-	// Another note: if the fault is not excited but the fault 
-	// location value is not X, then we have failed to activate 
-	// the fault. In this case getObjective should fail and Return false.  
-	// Otherwise, use the D-frontier to find an objective.
-
-	// Don't forget to call updateDFrontier() to make sure your dFrontier 
-	// (a global variable) is up to date.
-
-	// Remember, for Parts 1/2 if you want to match my reference solution exactly,
-	// you should choose the first gate in the D frontier (dFrontier[0]), and pick
-	// its first approrpriate input.
-	
-        //If fault location is 1 or 0 we have failed to excite the fault
-        if(faultLocation->getValue() == LOGIC_ONE || faultLocation->getValue() == LOGIC_ZERO){
-          return false;
-        }
-        //If fault location is X we need to excite the fault
-        if(faultLocation->getValue() == LOGIC_X){
-          g = faultLocation;
-          if(faultLocation->get_faultType() == FAULT_SA0) v = LOGIC_ONE;
-          else v = LOGIC_ZERO;
-          return true;
-        } 
-        //Once fault is excited we need to set 
-        //the remaining gate inputs to the controlling value
-        if(mode < 4)
-          updateDFrontier(myCircuit);
-        if(dFrontier.size() == 0) return false;
-        Gate* dGate;
-
-	//trying SCOAP Matrix 
-	//Did not produce intended results so 
-	//set mode to 9 which will never be the case
-        if(mode == 9){         
-          dGate = getGateWithMinObserv(dFrontier);
-          char gateType = dGate->get_gateType();
-          // We treat XOR as OR and XNOR as NOR
-          if(gateType == GATE_XOR){
-            gateType = GATE_OR;
-          }else if(gateType == GATE_XNOR) {
-            gateType = GATE_NOR;
-          }                                 
-          v = nonControllingValue(gateType);
-          bool gateSet = false;
-          if(v == LOGIC_ONE){
-            //cout << "Inside Logic 1" << endl;
-            gateSet = getInputWithMaxCC1(g, dGate->get_gateInputs());
-          }else{
-            //cout << "Inside Logic 0" << endl;
-            gateSet = getInputWithMaxCC0(g, dGate->get_gateInputs());
-          } 
-          return gateSet;
-        }
-        else{  
-          if(mode < 4)
-            dGate = dFrontier[0];
-          else{
-            int index = randNum(0, dFrontier.size()-1);
-            dGate = dFrontier[index];
-          }
-          char gateType = dGate->get_gateType();
-          // We treat XOR as OR and XNOR as NOR
-          if(gateType == GATE_XOR){
-            gateType = GATE_OR;
-          }else if(gateType == GATE_XNOR) {
-            gateType = GATE_NOR;
-          }
-          v = nonControllingValue(gateType); 
-          vector<Gate*> gInputs = dGate->get_gateInputs();
-          for(Gate* gInput:gInputs){
-            if(gInput->getValue() == LOGIC_UNSET || gInput->getValue() == LOGIC_X){
-              g = gInput;      
-              return true;
-            }
-          }     
-        }
-	return false;
-}
-
-
-// A very simple method to update the D frontier.
-/** @brief A simple method to compute the set of gates on the D frontier.
- *
- * \note For Part 1, you must write this. The simplest form follows the pseudocode included in the comments.
- */
-
-void updateDFrontier(Circuit* myCircuit) {
-
-	// TODO
-
-	// Procedure:
-	//  - clear the dFrontier vector (stored as the global variable dFrontier -- see the 
-	//    top of the file)
-	//  - loop over all gates in the circuit; for each gate, check if it should be on 
-	//    D-frontier; if it is, add it to the dFrontier vector.
-
-	// If you want to match my output exactly, go through the gates in this order:
-	//     for (int i=0; i < myCircuit->getNumberGates(); i++) {    
-	//         Gate* g = myCircuit->getGate(i);
-
-	// One way to improve speed for Part 4 would be to improve D-frontier management. 
-	// You can add/remove gates from the D frontier during simulation, instead of adding 
-	// an entire pass over all the gates like this.
-        
-        dFrontier.clear();
-        //setPIFanouts(myCircuit);
-        //We add a gate to the DFrontier if the gate has a D or a DBAR at the input but the 
-        //output value of the gate is X.
-        for(int i=0; i < myCircuit->getNumberGates(); i++){
-          Gate* g = myCircuit->getGate(i);
-          if(g && (g->getValue() == LOGIC_X)){
-            vector<Gate*> gInputs = g->get_gateInputs();
-            for(Gate* gInput:gInputs){
-              if(gInput->getValue() == LOGIC_D || gInput->getValue() == LOGIC_DBAR){
-                dFrontier.push_back(g);
-                break;
-              }
-            }
-          }
-        }
-        
-        return;
-
-}
-
-
-// Backtrace: given objective objGate and objVal, then figure out which input (pi) to set 
-// and which value (piVal) to set it to.
-
-/** @brief PODEM backtrace function
- * \param pi Output: A Gate pointer to the primary input your backtrace function found.
- * \param piVal Output: The value you want to set that primary input to
- * \param objGate Input: The objective Gate (computed by getObjective)
- * \param objVal Input: the objective value (computed by getObjective)
- * \param myCircuit Input: pointer to the Circuit being considered
- * \note Write this function based on the psuedocode from class.
- */
-void backtrace(Gate* &pi, char &piVal, Gate* objGate, char objVal, Circuit* myCircuit) {
-
-	// TODO
-
-	// Write your backtrace code here.
-
-	// If you want your solution to match mine exactly:
-	//   1. Go through the gate inputs in order; pick the first X input.
-	//   2. Treat XOR gates like they are OR and XNOR like they are NOR.
-	
-        Gate* i = objGate;
-        int numInversions = 0;
-
-        while(i->get_gateType() != GATE_PI){
-          char gateType = i->get_gateType();
-          if(gateType == GATE_NOT || gateType == GATE_NOR || gateType == GATE_NAND || gateType == GATE_XNOR) numInversions++;
-          vector<Gate*> gInputs = i->get_gateInputs();
-          for(Gate* gInput:gInputs){
-            if(gInput->getValue() == LOGIC_X){
-              i = gInput;
-              break;
-            }
-          } 
-        }
-        
-        pi = i;
-        if(numInversions%2 == 0) piVal = objVal;
-        else if(objVal == LOGIC_ZERO) piVal = LOGIC_ONE;
-        else if(objVal == LOGIC_ONE) piVal = LOGIC_ZERO;
-        
-        return;
-}
-
 ////////////////////////////////////////////////////////////////////////////
 // Please place any new functions you add here, between these two bars.
 
-  bool d_dbar_on_PO(Circuit* myCircuit){
-    vector<Gate*> myPOGates = myCircuit->getPOGates();
-    for(Gate* gate:myPOGates){
-      //cout << "primary output : " << gate->get_outputName() << " value " << gate->printValue() << endl;
-      if(gate->getValue() == LOGIC_D || gate->getValue() == LOGIC_DBAR) return true; 
-    }
-    return false;
-  }
-  
-  // Function to set the output values
-  // Since we have error only at output we check the gate output for 
-  // stuck at fault before we set the output value. If there is an error
-  // we set a D or a DBAR accordingly
-  void setGateOutputs(vector<Gate*>& circuitOuts){
-    int noOfGates = circuitOuts.size();
-    for(int i=0; i < noOfGates; i++){
-      Gate* gateOut = circuitOuts[i];
-      if(gateOut->getValue() == LOGIC_UNSET){
-        vector<Gate*> circuitInputs = gateOut->get_gateInputs();
-        int output = findGateValue(circuitInputs, gateOut->get_gateType());
-        if(gateOut->get_faultType() == NOFAULT) 
-          gateOut->setValue(output);
-        else
-          setValueForError(output, gateOut);
-      }
-    }
-  }
-  
-  // This function is used to set a D or a DBAR if 
-  // there is an error at the gate output
-  void setValueForError(int result, Gate* gate){
-    if(gate->get_faultType() == FAULT_SA0 && result == LOGIC_ONE){
-      gate->setValue(LOGIC_D);
-    }else if(gate->get_faultType() == FAULT_SA1 && result == LOGIC_ZERO){
-      gate->setValue(LOGIC_DBAR);
-    }else{
-      gate->setValue(result);
-    }
-  }
-  
-  //Find the gate output value based on the input. The function also has a 
-  //recursive call if the required values are not set
-  int findGateValue(vector<Gate*>& gates, int gateType){
-    int noOfGates = gates.size();
-    bool xValue = false, dValue = false, dbarValue = false;
-    if(gateType == GATE_XOR || gateType == GATE_XNOR){
-      return handleExclusiveGates(gates, gateType);
-    }
-    if(gateType == GATE_NOT){
-      return handleNot(gates);
-    }
-    if(gateType == GATE_BUFF || gateType == GATE_FANOUT){
-      return handleBuffFanout(gates);
-    }
-    
-    // AND, OR, NAND, NOR gates
-    for(int i=0; i<noOfGates; i++){
-      if(gates[i]->getValue() == LOGIC_UNSET) setGateOutputs(gates);
-      if(gates[i]->getValue() == LOGIC_X){
-        xValue = true;
-      } 
-      else if(gates[i]->getValue() == LOGIC_D){
-        dValue = true;
-      }
-      else if(gates[i]->getValue() == LOGIC_DBAR){
-        dbarValue = true;
-      }      
-      else if(isControllingValue(gates[i]->getValue(), gateType)) return controllingOutput(gateType);
-    }
-    
-    // D or DBAR means one of the values if a controlling value hence 
-    // return the controlling output
-    if(dValue && dbarValue ) return controllingOutput(gateType);
-    
-    //If there is no controlling value and an X value output is X  
-    if(xValue) return LOGIC_X;
-    
-    // D values and non-controlling values
-    if(dValue && (gateType == GATE_AND || gateType == GATE_OR)) return LOGIC_D;
-    if(dbarValue && (gateType == GATE_AND || gateType == GATE_OR)) return LOGIC_DBAR;
-    
-    // DBAR values and non-controlling values
-    if(dValue && (gateType == GATE_NAND || gateType == GATE_NOR)) return LOGIC_DBAR;
-    if(dbarValue && (gateType == GATE_NAND || gateType == GATE_NOR)) return LOGIC_D;
-    
-    // else case where all values are non controlling values
-    return nonControllingOutput(gateType);
-  }
-  
-  //check if input value is a controlling value based on the gate
-  bool isControllingValue(int input, int gateType){
-    if((gateType == GATE_NAND || gateType == GATE_AND) && input == LOGIC_ZERO) return true;  
-    if((gateType == GATE_NOR || gateType == GATE_OR) && input == LOGIC_ONE) return true;
-    return false;
-  }
-  
   //Return the controlling values of the gates
+  //(LOGIC_X for gates without one, e.g. XOR)
   int controllingOutput(int gateType){
     if(gateType == GATE_NAND) return LOGIC_ONE;
     if(gateType == GATE_AND) return LOGIC_ZERO;
     if(gateType == GATE_NOR) return LOGIC_ZERO;
     if(gateType == GATE_OR) return LOGIC_ONE; 
+    return LOGIC_X;
   }
 
-  //Return the non-controlling output values of the gates
-  int nonControllingOutput(int gateType){
-    if(gateType == GATE_NAND) return LOGIC_ZERO;
-    if(gateType == GATE_AND) return LOGIC_ONE;
-    if(gateType == GATE_NOR) return LOGIC_ONE;
-    if(gateType == GATE_OR) return LOGIC_ZERO; 
-  }
-  
   //Return the non-controlling input values of the gates
+  //(LOGIC_X for gates without one, e.g. XOR)
   int nonControllingValue(int gateType){
     if(gateType == GATE_NAND) return LOGIC_ONE;
     if(gateType == GATE_AND) return LOGIC_ONE;
     if(gateType == GATE_NOR) return LOGIC_ZERO;
     if(gateType == GATE_OR) return LOGIC_ZERO; 
+    return LOGIC_X;
   }
 
-  // Speacial Function to handle XOR and XNOR
-  int handleExclusiveGates(vector<Gate*>& gates, int gateType){
-    if(gates[0]->getValue() == LOGIC_UNSET) setGateOutputs(gates);
-    if(gates[1]->getValue() == LOGIC_UNSET) setGateOutputs(gates);
-    bool xValue = false, ones = false, zeros = false, dValue = false, dbarValue = false;
-    for(int i=0; i<2; i++){
-      if(gates[i]->getValue() == LOGIC_X) return LOGIC_X;
-      if(gates[i]->getValue() == LOGIC_ONE) ones = true;
-      if(gates[i]->getValue() == LOGIC_ZERO) zeros = true;
-      if(gates[i]->getValue() == LOGIC_D) dValue = true;
-      if(gates[i]->getValue() == LOGIC_DBAR) dbarValue = true;
-    }
-    // 1 & 0
-    if(zeros && ones && gateType == GATE_XOR) return LOGIC_ONE;
-    if(zeros && ones && gateType == GATE_XNOR) return LOGIC_ZERO;
-    // 0 & D
-    if(zeros && dValue && gateType == GATE_XOR) return LOGIC_D;
-    if(zeros && dValue && gateType == GATE_XNOR) return LOGIC_DBAR;
-    // 1 & D
-    if(ones && dValue && gateType == GATE_XOR) return LOGIC_DBAR;
-    if(ones && dValue && gateType == GATE_XNOR) return LOGIC_D;
-    // 0 & DBAR
-    if(zeros && dbarValue && gateType == GATE_XOR) return LOGIC_DBAR;
-    if(zeros && dbarValue && gateType == GATE_XNOR) return LOGIC_D;
-    // 1 & DBAR
-    if(ones && dbarValue && gateType == GATE_XOR) return LOGIC_D;
-    if(ones && dbarValue && gateType == GATE_XNOR) return LOGIC_DBAR;
-    // D & DBAR
-    if(dValue && dbarValue && gateType == GATE_XOR) return LOGIC_ONE;
-    if(dValue && dbarValue && gateType == GATE_XNOR) return LOGIC_ZERO;
-    // else both the logics are same in that case we need to return 0 for XOR and 1 XNOR
-    if(gateType == GATE_XOR) return LOGIC_ZERO;
-    if(gateType == GATE_XNOR) return LOGIC_ONE;
-    
-  }
- 
-  // speacial function to handle NOT gate
-  // return the complement of the input value
-  int handleNot(vector<Gate*>& gates){
-    if(gates[0]->getValue() == LOGIC_UNSET) setGateOutputs(gates);
-    if(gates[0]->getValue() == LOGIC_ONE) return LOGIC_ZERO;
-    if(gates[0]->getValue() == LOGIC_ZERO) return LOGIC_ONE;
-    if(gates[0]->getValue() == LOGIC_X) return LOGIC_X;
-    if(gates[0]->getValue() == LOGIC_D) return LOGIC_DBAR;
-    if(gates[0]->getValue() == LOGIC_DBAR) return LOGIC_D;
-      
-  }
-
-  // Speacial function to handle BUFF and FANOUT gates 
-  // Return the input values as is
-  int handleBuffFanout(vector<Gate*>& gates){
-    if(gates[0]->getValue() == LOGIC_UNSET) setGateOutputs(gates);
-    return gates[0]->getValue();
-  }
-   
-  void setPIFanouts(Circuit* myCircuit){
-    vector<Gate*> myCircuitPIs = myCircuit->getPIGates();
-    for(Gate* piGate:myCircuitPIs){
-      if(piGate->getValue() != LOGIC_X && piGate->getValue() != LOGIC_UNSET){
-        vector<Gate*> outputGates = piGate->get_gateOutputs();
-        for(Gate* outGate:outputGates){
-          if(outGate->get_gateType() == GATE_FANOUT){
-            setValueForError(piGate->getValue(), outGate);
-          }
-        }
-      }
-    }
-  }
-   
   //Function to set the equivalence for the circuit. We do a recursive 
   //DFS to set the equivalence for all the gates. The gates that has been visited 
   //is marked as visited so that we don't end up updating it again. The FANOUT XOR
   //and XNOR gates are not considered for equivalence.
-  void setAllEquivalentNodes(vector<Gate*>& circuitOuts, FaultEquiv& myFaultEquivGraph){
+  void setAllEquivalentNodes(GateView circuitOuts, FaultEquiv& myFaultEquivGraph){
     int noOfGates = circuitOuts.size();
     for(int i=0; i < noOfGates; i++){
       Gate* gateOut = circuitOuts[i];
@@ -1126,7 +845,7 @@ void backtrace(Gate* &pi, char &piVal, Gate* objGate, char objVal, Circuit* myCi
         if(isValidEquivGate(gateOut)){
           setEquivForGate(gateOut, myFaultEquivGraph);
         }
-        vector<Gate*> inputs = gateOut->get_gateInputs();
+        GateView inputs = gateOut->get_gateInputs();
         setAllEquivalentNodes(inputs, myFaultEquivGraph);
       }
     }
@@ -1144,7 +863,7 @@ void backtrace(Gate* &pi, char &piVal, Gate* objGate, char objVal, Circuit* myCi
   //equivalent to the output stuck at. For AND, OR, NAND, NOR the controlling output stuck at
   //is equivalent to controlling input stuck at.
   void setEquivForGate(Gate* gate, FaultEquiv& myFaultEquivGraph){
-    vector<Gate*> inputs = gate->get_gateInputs();
+    GateView inputs = gate->get_gateInputs();
     char gateType = gate->get_gateType();
     if(gateType == GATE_NOT){
       myFaultEquivGraph.mergeFaultEquivNodes(gate, FAULT_SA0, inputs[0], FAULT_SA1);
@@ -1171,246 +890,80 @@ void backtrace(Gate* &pi, char &piVal, Gate* objGate, char objVal, Circuit* myCi
     }
   }
 
-  //Function to remove gate from DFrontier Once it has 
-  //a D or DBAR on its output. 
-  void removeGateFromDFrontier(Gate* outGate){
-    int noOfGates = dFrontier.size();
-    for(int i=0; i<noOfGates; i++){
-      if(dFrontier[i] == outGate){
-        dFrontier.erase(dFrontier.begin()+i);
-        break;
-      }
-    }
-  }
-
   //Main function to setup the SCOAP Values
-  //Sets up the Input Controlability and 
-  //output Observability and calls the recursive function to set
-  //all the 3 values for each gate
+  //The netlist computes CC0 and CC1 in one pass over the gates in level order,
+  //and CO in one pass in reverse level order (see Netlist::computeSCOAP()).
+  //The Gates read the values from the netlist.
   void setSCOAPValues(Circuit* myCircuit){
-    vector<Gate*> myCircuitPIs = myCircuit->getPIGates();
-    for(Gate* inGate:myCircuitPIs){
-      inGate->set_CC0(CC_IN);
-      inGate->set_CC1(CC_IN);
-    }
-    vector<Gate*> myCircuitPOs = myCircuit->getPOGates();
-    setControlability(myCircuitPOs);
-    for(Gate* outGate:myCircuitPOs)
-      outGate->set_CO(CO_OUT);
-    setObservability(myCircuitPOs);
-  }
-  
-  //Helper function to print out the scoap values for all
-  //of the gates in the circuit
-  void printSCOAPValues(vector<Gate*> outputs){
-    for(Gate* outGate:outputs){
-      cout << "Gate Name :: " << outGate->get_outputName() << endl;
-      cout << "CC0 :: " << outGate->get_CC0() << endl;
-      cout << "CC1 :: " << outGate->get_CC1() << endl;
-      cout << "CO :: " << outGate->get_CO() << endl;
-      printSCOAPValues(outGate->get_gateInputs());
-    }
-  }
-
-  //The recursive function that Sets up the controlability 
-  //for all the gates. Checks if controlability is UNSET and 
-  //cals the set_CC0_CC1() for a single gate based on its inputs
-  void setControlability(vector<Gate*> outputs){
-    for(Gate* outGate:outputs){
-      if(outGate->get_CC0() == CC_UNSET || outGate->get_CC1() == CC_UNSET){
-        vector<Gate*> inputs = outGate->get_gateInputs();
-        for(Gate* inGate:inputs){
-          if(inGate->get_CC0() == CC_UNSET || inGate->get_CC1() == CC_UNSET) setControlability(inputs);      
-        }
-        set_CC0_CC1(outGate, inputs);
-      }
-    }
-  }
-  
-  //Function to setup CC0 and CC1 for a particular gate based on the input
-  //CC0 and CC1 values.
-  void set_CC0_CC1(Gate* outGate, vector<Gate*> inputs){
-    int gateType = outGate->get_gateType();     
-    if(gateType == GATE_BUFF){        // BUFF simply adds one to the controlability
-      outGate->set_CC0(inputs[0]->get_CC0() + 1);
-      outGate->set_CC1(inputs[0]->get_CC1() + 1);
-    }else if(gateType == GATE_FANOUT){ // FANOUT is not a gate we put it to differntiate between fanout branches same CC0 CC1
-      outGate->set_CC0(inputs[0]->get_CC0());
-      outGate->set_CC1(inputs[0]->get_CC1());
-    }else if(gateType == GATE_NOT){ // NOT adds one 
-      outGate->set_CC0(inputs[0]->get_CC1() + 1);
-      outGate->set_CC1(inputs[0]->get_CC0() + 1);
-    }else if(gateType == GATE_AND || gateType == GATE_NAND){ // AND,NAND CC0,CC1 = minCC0 + 1, CC1,CC0 = sumCC1 +1 respectively
-      int minCC0 = inputs[0]->get_CC0(), sumCC1 = 0;
-      for(Gate* inGate:inputs){
-        sumCC1 += inGate->get_CC1();
-        if(minCC0 > inGate->get_CC0()) minCC0 = inGate->get_CC0();
-      }
-      if(gateType == GATE_AND){
-        outGate->set_CC0(minCC0 + 1);
-        outGate->set_CC1(sumCC1 + 1);
-      }else{
-        outGate->set_CC1(minCC0 + 1);
-        outGate->set_CC0(sumCC1 + 1);
-      }
-    }else if(gateType == GATE_OR || gateType == GATE_NOR){ //OR, NOR CC0,CC1 = sumCC0+1, CC1,CC0 = minCC1 +1 respectively
-      int minCC1 = inputs[0]->get_CC1(), sumCC0 = 0;
-      for(Gate* inGate:inputs){
-        sumCC0 += inGate->get_CC0();
-        if(minCC1 > inGate->get_CC1()) minCC1 = inGate->get_CC1();
-      }
-      if(gateType == GATE_OR){
-        outGate->set_CC1(minCC1 + 1);
-        outGate->set_CC0(sumCC0 + 1);
-      }else{
-        outGate->set_CC0(minCC1 + 1);
-        outGate->set_CC1(sumCC0 + 1);
-      }
-    }else if(gateType == GATE_XOR){
-      int cc1_a = inputs[0]->get_CC1(), cc0_a = inputs[0]->get_CC0(), cc1_b = inputs[1]->get_CC1(), cc0_b = inputs[1]->get_CC0();
-      outGate->set_CC0(min(cc1_a + cc1_b, cc0_a + cc0_b) + 1);
-      outGate->set_CC1(min(cc1_a + cc0_b, cc0_a + cc1_b) + 1);
-    }else if(gateType == GATE_XNOR){
-      int cc1_a = inputs[0]->get_CC1(), cc0_a = inputs[0]->get_CC0(), cc1_b = inputs[1]->get_CC1(), cc0_b = inputs[1]->get_CC0();
-      outGate->set_CC1(min(cc1_a + cc1_b, cc0_a + cc0_b) + 1);
-      outGate->set_CC0(min(cc1_a + cc0_b, cc0_a + cc1_b) + 1);
-    }
-  }
-  
-  void setObservability(vector<Gate*> outputs){
-    for(Gate* outGate:outputs){
-      vector<Gate*> inputs = outGate->get_gateInputs();
-      for(Gate* inGate:inputs){
-        if(inGate->get_CO() == CC_UNSET) set_CO(outGate, inputs);
-      }
-      setObservability(inputs);
-    }
+    myCircuit->getNetlist()->computeSCOAP();
   }
   
-  //Function to setup Observability for a particular gate 
-  //It dicides the function according to the gate type and
-  //sets up the required observability
-  void set_CO(Gate* outGate, vector<Gate*> inputs){
-    int gateType = outGate->get_gateType();
-    int outputObservability = outGate->get_CO();
-    if(outputObservability == CC_UNSET) return;
-    int sumCC0 = 0, sumCC1 = 0;
-    for(Gate* inGate:inputs){
-      sumCC0 += inGate->get_CC0();
-      sumCC1 += inGate->get_CC1();
-    }
-    for(Gate* inGate:inputs){
-      if(gateType == GATE_AND || gateType == GATE_NAND){
-        inGate->set_CO(outputObservability + sumCC1 + 1 - inGate->get_CC1());
-      }
-      if(gateType == GATE_OR || gateType == GATE_NOR){
-        inGate->set_CO(outputObservability + sumCC0 + 1 - inGate->get_CC0());      
-      }
-      if(gateType == GATE_BUFF || gateType == GATE_NOT){
-        inGate->set_CO(outputObservability + 1);
-      }
-      if(gateType == GATE_XOR || gateType == GATE_XNOR){
-        //cout << "Gate Number" << inGate->get_outputName() << endl;
-        //cout << "Output Observability " << outputObservability << " Sum CC0 " << sumCC0 << " Sum CC1 " << sumCC1 << endl;
-        inGate->set_CO(outputObservability +  1 + min(sumCC0 - inGate->get_CC0(), sumCC1 - inGate->get_CC1()));
-      }
-      if(gateType == GATE_FANOUT){
-        int minObserv = outputObservability;
-        vector<Gate*> branches = inGate->get_gateOutputs();
-        for(Gate* branch:branches){
-          if(branch->get_CO() < minObserv) minObserv = branch->get_CO();
+  //Prints the testability report: the SCOAP values of every gate in level order,
+  //then the hardest gate to set to 0, to 1 and to observe.
+  //setSCOAPValues() must have been run. A gate that reaches no PO has no CO ("-"),
+  //and a value that hit SCOAP_MAX is printed as "max".
+  void printSCOAPReport(Circuit* myCircuit, ostream& out){
+    Netlist* nl = myCircuit->getNetlist();
+    const vector<int>& order = nl->getLevelOrder();
+    auto scoapString = [](int v) -> string {
+      if(v == CC_UNSET) return "-";
+      if(v >= SCOAP_MAX) return "max";
+      return to_string(v);
+    };
+    int hardest[3] = {-1, -1, -1};   // gate with the largest CC0, CC1 and CO
+    int largest[3] = {CC_UNSET, CC_UNSET, CC_UNSET};
+    int unobservable = 0;
+    out << "Gate\tLevel\tCC0\tCC1\tCO" << endl;
+    for(int g:order){
+      const scoapStruct& s = nl->getSCOAP(g);
+      int v[3] = {s.cc0, s.cc1, s.co};
+      out << myCircuit->getGate(g)->get_outputName() << "\t" << nl->getLevel(g);
+      for(int i = 0; i < 3; i++){
+        out << "\t" << scoapString(v[i]);
+        if(v[i] > largest[i]){
+          largest[i] = v[i];
+          hardest[i] = g;
         }
-        inGate->set_CO(minObserv);
       }
+      out << endl;
+      if(s.co == CC_UNSET) unobservable++;
     }
-  }
-  
-  //Get the gate with minimum Observability in the dFrontier
-  Gate* getGateWithMinObserv(vector<Gate*> dFrontier){
-    Gate* reqGate = dFrontier[0];
-    for(Gate* gate:dFrontier){
-      if(gate->get_CO() < reqGate->get_CO()) reqGate = gate;
+    out << endl << "Gates: " << nl->getNumberGates() << ", levels: " << nl->getNumberLevels() << endl;
+    const char* names[3] = {"CC0", "CC1", "CO"};
+    for(int i = 0; i < 3; i++){
+      if(hardest[i] < 0) continue;
+      out << "Largest " << names[i] << ": " << scoapString(largest[i]) << " (" << myCircuit->getGate(hardest[i])->get_outputName() << ")" << endl;
     }
-    return reqGate;
-  }
-
-  //Input with maximum CC1
-  //We use maximum because we anyway have to set the non controlling values so make the 
-  //algorithm fail earlier by trying the hardest values.
-  bool getInputWithMaxCC1(Gate* &result, vector<Gate*> inputs){
-    int maxCC1 = -1;
-    for(Gate* inGate:inputs){
-      if((inGate->getValue() == LOGIC_UNSET || inGate->getValue() == LOGIC_X) && inGate->get_CC1() > maxCC1){
-        maxCC1 = inGate->get_CC1();
-        result = inGate;
-      }
-    }
-    if(maxCC1 == -1) return false;
-    else return true;
+    out << "Gates reaching no PO: " << unobservable << endl;
   }
   
-  //Input with maximum CC0
-  //We use maximum because we anyway have to set the non controlling values so make the 
-  //algorithm fail earlier by trying the hardest values.
-  bool getInputWithMaxCC0(Gate* &result, vector<Gate*> inputs){
-    int maxCC0 = -1;
-    for(Gate* inGate:inputs){
-      if((inGate->getValue() == LOGIC_UNSET || inGate->getValue() == LOGIC_X) && inGate->get_CC0() > maxCC0){
-        maxCC0 = inGate->get_CC0();
-        result = inGate;
-      }
-    }
-    if(maxCC0 == -1) return false;
-    else return true;
-  }
-
-  //randon number generator
-  //reference http://www.cplusplus.com/forum/beginner/183358/
-  int randNum(int min, int max){
-    return rand() % (max-min+1) + min;
-  }  
-
 //Helper function to validate the results from mode 5. 
-//Runs simFullCircuit for all the outputs generated by our algorithm for the 
-//origFaultList and puts all the faults detected into a set and we check the 
-//size of the set to determine the unique defects detected by the test vectors
+//Fault-simulates all the test vectors generated by our algorithm against the
+//origFaultList with the FaultSim and reports, for every fault, the first test
+//that detects it; the number of detected faults gives the unique defects 
+//detected by the test vectors.
 void validateResultsFromATPG(Circuit* myCircuit, vector<faultStruct>& origFaultList, vector<vector<char>>& allTests, vector<faultStruct> undetectableFaults){
-	unordered_set<string> faultsFound;
-	//for(faultStruct fault:undetectableFaults) faultsFound.insert(fault.loc->get_outputName() + fault.val);
-	for(vector<char> test:allTests){
-		//Set circuit PI values as the inputs test vector
-		vector<Gate*> myCircuitPIs = myCircuit->getPIGates();
-		for(faultStruct fault:origFaultList){
-			if(faultsFound.find(fault.loc->get_outputName() + fault.val) != faultsFound.end()) continue;
-			// Clear the old fault in your circuit, if any.
-			myCircuit->clearFaults();
-			// Set up the fault we are trying to detect
-			faultLocation  = fault.loc;
-			char faultType = fault.val;
-			faultLocation->set_faultType(faultType);      
-					
-			// Set all gate values except PIs to UNSET
-			for (int i=0; i < myCircuit->getNumberGates(); i++) {
-				if(myCircuit->getGate(i)->get_gateType() != GATE_PI)
-					myCircuit->getGate(i)->setValue(LOGIC_UNSET);
-			}
-	
-			//We need to reset the PIs as previous fault may have set it to D or DBAR	
-			for(int i=0; i<test.size(); i++) myCircuitPIs[i]->setValue(test[i]);
-				
-			//Run full circuit simulation by calling the simFullCircuit method
-			simFullCircuit(myCircuit);
-			vector<Gate*> circuitPOs = myCircuit->getPOGates();
-
-			for(Gate* poGate:circuitPOs){
-				if(poGate->getValue() == LOGIC_D || poGate->getValue() == LOGIC_DBAR) {
-					faultsFound.insert(fault.loc->get_outputName() + fault.val);
-					break;
-				}
-			}
-		} 
+	// The fault list may repeat a fault; each unique (gate ID, stuck-at value) is
+	// simulated once, and faultIndex maps each list entry to its FaultSim fault.
+	FaultSim faultSim(myCircuit->getNetlist());
+	unordered_map<int, int> uniqueFaults;
+	vector<int> faultIndex;
+	for(faultStruct fault:origFaultList){
+		int faultKey = 2*fault.loc->get_gateID() + fault.val;
+		if(uniqueFaults.find(faultKey) == uniqueFaults.end())
+			uniqueFaults[faultKey] = faultSim.addFault(fault.loc->get_gateID(), fault.val);
+		faultIndex.push_back(uniqueFaults[faultKey]);
 	}
-	cout << faultsFound.size() << " faults of the " << origFaultList.size() << " detected" << endl;
+	faultSim.simulate(allTests);
+
+	for(int i = 0; i < origFaultList.size(); i++){
+		cout << origFaultList[i].loc->get_outputName() << "/" << (int)origFaultList[i].val << ": ";
+		if(faultSim.isDetected(faultIndex[i]))
+			cout << "first detected by test " << faultSim.getFirstDetection(faultIndex[i]) << endl;
+		else
+			cout << "not detected" << endl;
+	}
+	cout << faultSim.getNumberDetected() << " faults of the " << origFaultList.size() << " detected" << endl;
 }
 
 //This function is created to make use of the dominance relationships 
@@ -1419,18 +972,19 @@ void validateResultsFromATPG(Circuit* myCircuit, vector<faultStruct>& origFaultL
 //parents as already detected. If the leaf node is not detectable we go up the 
 //tree in a DFS format and check for a test untill we either successfully find the
 //fault or we are sure that the defect is undetectable. The function also makes
-//use of the X values. We set them as 0 and 1 randomly and then run a simFullCircuit
+//use of the X values. We set them as 0 and 1 randomly and then fault simulate the test
 //for all the remaining defects in our list and taking off all detected defects and 
 //the dominated nodes of the list. 
 void runPODEMForNode(faultEquivNode* equivNode, Circuit* myCircuit, vector<faultStruct>& undetectableFaults,vector<vector<char>>& allTests, 
-                    ofstream& outputStream, unordered_set<faultEquivNode*>& nodesTraversed, vector<faultEquivNode*>& faultEquivNodes){
+                    ofstream& outputStream, unordered_set<faultEquivNode*>& nodesTraversed, vector<faultEquivNode*>& faultEquivNodes,
+                    FaultSim& nodeFaultSim, PodemWorker& podem){
 
 	//DFS like traversal of the dominant nodes
 	vector<faultEquivNode*> dominantNodes = equivNode->dominatedBy;
         //First Iterate over children before we find a test for the given defect
 	if(dominantNodes.size() > 0){	
 		for(faultEquivNode* dominantNode:dominantNodes) 
-			runPODEMForNode(dominantNode, myCircuit, undetectableFaults, allTests, outputStream, nodesTraversed, faultEquivNodes);
+			runPODEMForNode(dominantNode, myCircuit, undetectableFaults, allTests, outputStream, nodesTraversed, faultEquivNodes, nodeFaultSim, podem);
 	}
 
 	//Once we have checked all the children we check if this defect was already marked as 
@@ -1440,93 +994,37 @@ void runPODEMForNode(faultEquivNode* equivNode, Circuit* myCircuit, vector<fault
 		
 		//Set this node in traversed list
 		nodesTraversed.insert(equivNode);
-		// Clear the old fault in your circuit, if any.
-		myCircuit->clearFaults();
-		vector<faultStruct> equivFaults = equivNode->equivFaults;			        
-		// Set up the fault we are trying to detect
-		faultLocation  = equivFaults[0].loc;
-		char faultType = equivFaults[0].val;
-		faultLocation->set_faultType(faultType);      
-		faultActivationVal = (faultType == FAULT_SA0) ? LOGIC_ONE : LOGIC_ZERO;
-	
-		// Set all gate values to X
-		for (int i=0; i < myCircuit->getNumberGates(); i++) {
-			myCircuit->getGate(i)->setValue(LOGIC_X);
-		}
+		faultStruct fault = equivNode->equivFaults[0];
 
-		// initialize the D frontier.
-		dFrontier.clear();
-	
-		// call PODEM recursion function
-		bool res = podemRecursion(myCircuit);
-		vector<Gate*> circuitPIs = myCircuit->getPIGates();
+		// call PODEM for the fault
+		int res = podem.run(fault.loc->get_gateID(), fault.val);
+		vector<char> test;
+		if(res == PODEM_DETECTED) podem.getTest(test);
 		
 		// Set the X values to 0 or 1 randomly
-		for(Gate* piGate:circuitPIs){
-			if(piGate->getValue() == LOGIC_X){
-				int num = randNum(0,1);
-				if(num == 1){
-					piGate->setValue(LOGIC_ONE);
-				}else{ 
-					piGate->setValue(LOGIC_ZERO);
-				}
-			}
-		}
+		fillXValues(test);
 		
-		//Prints the results to the output file and console
-		printPODEMResult(res, myCircuit, undetectableFaults, allTests, outputStream, faultType);
+		//Prints the results to the output file and console; the test found is the last of allTests,
+		//with D and DBAR on a faulty PI replaced by 1 and 0
+		reportPODEMResult(res, test, fault, undetectableFaults, allTests, outputStream);
 		
 		//If the test vector was able to detect a fault we check if it can find other faults
 		//that have not been detected already and add dominated nodes to detected
-		if(res){
+		if(res == PODEM_DETECTED){
 			addDominatedNodesToSet(equivNode->dominates, nodesTraversed);	
-			vector<char> test;
-			//Save the test vector since we will need to initialze it for all the test vectors
-			for(Gate* piGate:circuitPIs){
-				if(piGate->getValue() == LOGIC_D){
-					//cout << "Inside PI logic D" << endl;
-					piGate->setValue(LOGIC_ONE);
-				}else if(piGate->getValue() == LOGIC_DBAR){
-					//cout << "Inside PI Logic DBAR" << endl;
-					piGate->setValue(LOGIC_ZERO);
-				}
-				test.push_back(piGate->getValue());
-			}
+			test = allTests.back();
 			
-			//try unfound tests 
-			for(faultEquivNode* node:faultEquivNodes){
-				if(nodesTraversed.find(node) != nodesTraversed.end()) continue;
-				//cout << "Inside nodes check" << endl;
-				// Clear the old fault in your circuit, if any.
-				myCircuit->clearFaults();
-				vector<faultStruct> nodeFaults = node->equivFaults;			        
-				// Set up the fault we are trying to detect
-				faultLocation  = nodeFaults[0].loc;
-				char faultType = nodeFaults[0].val;
-				faultLocation->set_faultType(faultType);      
-					
-				// Set all gate values to UNSET
-				for (int i=0; i < myCircuit->getNumberGates(); i++) {
-					if(myCircuit->getGate(i)->get_gateType() != GATE_PI)
-						myCircuit->getGate(i)->setValue(LOGIC_UNSET);
-				}	
-				
-				//We need to reset the PIs as previous fault may have set it to D or DBAR				
-				for(int i=0; i<test.size(); i++) circuitPIs[i]->setValue(test[i]);
-				
-				
-				//Run full circuit simulation by calling the simFullCircuit method
-				simFullCircuit(myCircuit);
-				vector<Gate*> circuitPOs = myCircuit->getPOGates();
-				
-				//Add dominant nodes to nodesTraversed
-				for(Gate* poGate:circuitPOs){
-					if(poGate->getValue() == LOGIC_D || poGate->getValue() == LOGIC_DBAR) {
-						nodesTraversed.insert(node);
-						addDominatedNodesToSet(node->dominates, nodesTraversed);
-						break;
-					}
-				}
+			//try unfound tests: fault-simulate this test against every node not traversed yet
+			//and add the detected nodes and the nodes they dominate to nodesTraversed
+			for(int k = 0; k < faultEquivNodes.size(); k++){
+				if(nodesTraversed.find(faultEquivNodes[k]) != nodesTraversed.end())
+					nodeFaultSim.dropFault(k);
+			}
+			vector<int> detectedNodes;
+			nodeFaultSim.simulate(vector<vector<char>>(1, test), &detectedNodes);
+			for(int k:detectedNodes){
+				nodesTraversed.insert(faultEquivNodes[k]);
+				addDominatedNodesToSet(faultEquivNodes[k]->dominates, nodesTraversed);
 			}
 		}
 	}
@@ -1541,5 +1039,361 @@ void addDominatedNodesToSet(vector<faultEquivNode*> nodes,unordered_set<faultEqu
 	}
 }
 
+/** @brief Random-pattern phase: detects the easy faults with random patterns before PODEM runs.
+ *  \param myCircuit The circuit
+ *  \param faultList The faults to target; the faults the random patterns detect are removed from it.
+ *  \param allTests The kept patterns are added to it
+ *  \param outputStream The kept patterns are written to it, one per line, like PODEM's tests
+ *
+ * Batches of 64 pseudo-random patterns (from a fixed seed, so runs are repeatable) are fault
+ * simulated against the faults not detected yet, until a batch detects less than randomThreshold
+ * percent of the faults, or all of them. Only patterns that are the first to detect some fault
+ * are kept.
+ */
+void randomPatternPhase(Circuit* myCircuit, vector<faultStruct>& faultList, vector<vector<char>>& allTests, ofstream& outputStream){
+	FaultSim faultSim(myCircuit->getNetlist(), PATTERNS_PER_WORD);
+	for (int i=0; i<faultList.size(); i++)
+		faultSim.addFault(faultList[i].loc->get_gateID(), faultList[i].val);
+
+	mt19937 generator(1);
+	int numPIs = myCircuit->getPIGates().size();
+	vector<vector<char>> batch(PATTERNS_PER_WORD, vector<char>(numPIs));
+	vector<char> useful(PATTERNS_PER_WORD);
+	vector<int> detected;
+	int kept = 0;
+	while (faultSim.getNumberDetected() < faultList.size()) {
+		for (int p=0; p<batch.size(); p++)
+			for (int i=0; i<numPIs; i++)
+				batch[p][i] = (generator() & 1) ? LOGIC_ONE : LOGIC_ZERO;
+
+		// a pattern is kept if it is the first to detect some fault
+		int first = faultSim.getNumberPatterns();
+		detected.clear();
+		faultSim.simulate(batch, &detected);
+		useful.assign(batch.size(), 0);
+		for (int f:detected)
+			useful[faultSim.getFirstDetection(f) - first] = 1;
+		for (int p=0; p<batch.size(); p++) {
+			if (!useful[p])
+				continue;
+			for (int i=0; i<numPIs; i++)
+				outputStream << printPIValue(batch[p][i]);
+			outputStream << endl;
+			allTests.push_back(batch[p]);
+			kept++;
+		}
+
+		if (100.0 * detected.size() / faultList.size() < randomThreshold)
+			break;
+	}
+
+	cout << "Random patterns: " << kept << " kept of " << faultSim.getNumberPatterns() << " simulated, detecting "
+	     << faultSim.getNumberDetected() << " of " << faultList.size() << " faults" << endl;
+
+	// PODEM only has to target the rest
+	vector<faultStruct> remaining;
+	for (int i=0; i<faultList.size(); i++)
+		if (!faultSim.isDetected(i))
+			remaining.push_back(faultList[i]);
+	detectedCount += faultList.size() - remaining.size();
+	faultList = remaining;
+}
+
+/** @brief Replaces the X values of a test by pseudo-random 0s and 1s (from fillGenerator).
+ *  \param test The test, one value per PI
+ */
+void fillXValues(vector<char>& test){
+	for (int i=0; i<test.size(); i++)
+		if (test[i] == LOGIC_X)
+			test[i] = (fillGenerator() & 1) ? LOGIC_ONE : LOGIC_ZERO;
+}
+
+/** @brief Fault simulates a new test against the faults not detected yet, and drops the ones it detects (option -d).
+ *  \param test The test, one value per PI
+ *  \param faultSim Holds the fault list: fault k is the k-th fault of the list. Faults already
+ *  targeted must have been dropped from it.
+ *  \param dropped Entry k is set to 1 if the test detects fault k
+ *  \param pool If not NULL, the detected faults are also dropped from this PodemPool
+ */
+void dropDetectedFaults(const vector<char>& test, FaultSim& faultSim, vector<char>& dropped, PodemPool* pool){
+	vector<int> detected;
+	faultSim.simulate(vector<vector<char>>(1, test), &detected);
+	for (int k:detected) {
+		dropped[k] = 1;
+		if (pool != NULL)
+			pool->dropFault(k);
+	}
+}
+
+/** @brief Reports a fault that is not targeted because an earlier test detects it (option -d).
+ *  \param fault The fault
+ */
+void reportDroppedFault(faultStruct fault){
+	cout << "Fault = " << fault.loc->get_outputName() << " / " << (int)(fault.val) << "; detected by an earlier test; " << endl;
+	detectedCount++;
+}
+
+/** @brief Dynamic compaction: packs secondary faults into the X inputs of a test (option -c).
+ *  \param cube The test found for the primary fault, one value per PI. D and D' are replaced by
+ *  1 and 0, and X values are set as secondary faults are added.
+ *  \param primary The index of the primary fault in faultList
+ *  \param faultList The faults being targeted
+ *  \param dropped Entry k is 1 if fault k needs no test; set for each secondary fault added
+ *  \param compactor The PodemWorker used to target the secondary faults
+ *  \param pool If not NULL, the secondary faults are also dropped from this PodemPool
+ *  \return The number of secondary faults added.
+ *
+ * The faults after the primary one that are not dropped are tried in order, until the cube has
+ * no X left. Each one is targeted by PODEM with the cube's 0s and 1s fixed, and at most
+ * secondaryBacktrackLimit backtracks; if a test is found, it becomes the new cube.
+ */
+int compactTest(vector<char>& cube, int primary, vector<faultStruct>& faultList, vector<char>& dropped, PodemWorker& compactor, PodemPool* pool){
+	int numX = 0;
+	for (int i=0; i<cube.size(); i++) {
+		if (cube[i] == LOGIC_D)
+			cube[i] = LOGIC_ONE;
+		else if (cube[i] == LOGIC_DBAR)
+			cube[i] = LOGIC_ZERO;
+		else if (cube[i] == LOGIC_X)
+			numX++;
+	}
+
+	int added = 0;
+	for (int k = primary+1; (k < faultList.size()) && (numX > 0); k++) {
+		if (dropped[k])
+			continue;
+		if (compactor.run(faultList[k].loc->get_gateID(), faultList[k].val, &cube) != PODEM_DETECTED)
+			continue;
+
+		compactor.getTest(cube);
+		numX = 0;
+		for (int i=0; i<cube.size(); i++) {
+			if (cube[i] == LOGIC_D)
+				cube[i] = LOGIC_ONE;
+			else if (cube[i] == LOGIC_DBAR)
+				cube[i] = LOGIC_ZERO;
+			else if (cube[i] == LOGIC_X)
+				numX++;
+		}
+		dropped[k] = 1;
+		if (pool != NULL)
+			pool->dropFault(k);
+		added++;
+	}
+	return added;
+}
+
+/** @brief Static compaction of the final test set (options -s and -g).
+ *  \param myCircuit The circuit
+ *  \param faults The faults the tests were generated for
+ *  \param allTests The tests, in the order they were generated (not changed)
+ *  \param fileName The compacted tests are written to this file, one per line
+ *
+ * Three passes, each keeping the fault coverage of the test set:
+ *  1. Merging: each test is merged into the first earlier (merged) test it does not conflict
+ *     with, i.e. no PI is 0 in one and 1 in the other. A merged test specifies every value the
+ *     two tests specify, so it detects everything either of them detects. The remaining X
+ *     values are then filled in (from fillGenerator).
+ *  2. Reverse-order fault simulation: the tests are fault simulated last to first, with fault
+ *     dropping, and a test is dropped if it detects no fault the later tests did not.
+ *  3. With -g, a greedy set cover: starting from no tests, repeatedly add the test detecting the
+ *     most faults not detected yet (the first one, if there is a tie).
+ */
+void staticCompaction(Circuit* myCircuit, vector<faultStruct>& faults, vector<vector<char>>& allTests, string fileName){
+	int numPIs = myCircuit->getPIGates().size();
+
+	// 1. Merge compatible test cubes
+	vector<vector<char>> merged;
+	for (int t=0; t<allTests.size(); t++) {
+		bool done = false;
+		for (int m=0; (m<merged.size()) && !done; m++) {
+			bool compatible = true;
+			for (int i=0; (i<numPIs) && compatible; i++)
+				compatible = (allTests[t][i] == LOGIC_X) || (merged[m][i] == LOGIC_X) || (allTests[t][i] == merged[m][i]);
+			if (!compatible)
+				continue;
+			for (int i=0; i<numPIs; i++)
+				if (merged[m][i] == LOGIC_X)
+					merged[m][i] = allTests[t][i];
+			done = true;
+		}
+		if (!done)
+			merged.push_back(allTests[t]);
+	}
+	for (int m=0; m<merged.size(); m++)
+		fillXValues(merged[m]);
+
+	// 2. Reverse-order fault simulation: a test is kept if it is the first (in reverse
+	// order) to detect some fault.
+	FaultSim faultSim(myCircuit->getNetlist());
+	for (int f=0; f<faults.size(); f++)
+		faultSim.addFault(faults[f].loc->get_gateID(), faults[f].val);
+	vector<vector<char>> reversed(merged.rbegin(), merged.rend());
+	faultSim.simulate(reversed);
+	vector<char> needed(reversed.size(), 0);
+	for (int f=0; f<faults.size(); f++)
+		if (faultSim.isDetected(f))
+			needed[faultSim.getFirstDetection(f)] = 1;
+	vector<vector<char>> compacted;
+	for (int t=reversed.size()-1; t>=0; t--)
+		if (needed[t])
+			compacted.push_back(reversed[t]);
+	int afterReverse = compacted.size();
+
+	// 3. Greedy set cover
+	if (staticCompactionLevel >= 2) {
+		FaultSim coverSim(myCircuit->getNetlist());
+		for (int f=0; f<faults.size(); f++)
+			coverSim.addFault(faults[f].loc->get_gateID(), faults[f].val);
+		vector<vector<int>> detects;
+		coverSim.getDetectedFaults(compacted, detects);
+
+		vector<char> covered(faults.size(), 0);
+		vector<char> chosen(compacted.size(), 0);
+		vector<vector<char>> cover;
+		while (true) {
+			int best = -1, bestCount = 0;
+			for (int t=0; t<compacted.size(); t++) {
+				if (chosen[t])
+					continue;
+				int count = 0;
+				for (int f:detects[t])
+					count += !covered[f];
+				if (count > bestCount) {
+					best = t;
+					bestCount = count;
+				}
+			}
+			if (best < 0)
+				break;
+			chosen[best] = 1;
+			for (int f:detects[best])
+				covered[f] = 1;
+			cover.push_back(compacted[best]);
+		}
+		compacted = cover;
+	}
+
+	ofstream compactStream(fileName);
+	if (!compactStream.is_open()) {
+		cout << "ERROR: Cannot open file " << fileName << " for output" << endl;
+		return;
+	}
+	for (int t=0; t<compacted.size(); t++) {
+		for (int i=0; i<numPIs; i++)
+			compactStream << printPIValue(compacted[t][i]);
+		compactStream << endl;
+	}
+	compactStream.close();
+
+	cout << "Static compaction: " << allTests.size() << " tests, " << merged.size() << " after merging, "
+	     << afterReverse << " after reverse-order fault simulation";
+	if (staticCompactionLevel >= 2)
+		cout << ", " << compacted.size() << " after set cover";
+	cout << "; " << faultSim.getNumberDetected() << " of " << faults.size() << " faults detected; written to " << fileName << endl;
+}
+
 ////////////////////////////////////////////////////////////////////////////
 
+
+/** @brief Microbenchmark of the gate evaluation kernels (option -k).
+ *
+ * The Netlist picks a kernel for each gate by its type and number of inputs (see
+ * Netlist::getKernel()), for both the 5-valued simulator (Netlist::evaluate()) and the
+ * bit-parallel one (PatternSim::evaluateGate()). For each kernel this circuit uses, this
+ * times evaluating all of its gates, on random input values, with that kernel and with the
+ * generic kernel for the gate type, and prints the time per gate evaluation of each.
+ * Gates whose kernel is the generic one (too many inputs) are timed once.
+ * With -x, it also times simulating the whole fault-free circuit with and without the
+ * compiled code (see CompiledSim).
+ */
+void benchmarkKernels(Circuit* myCircuit){
+  Netlist* nl = myCircuit->getNetlist();
+  int numGates = nl->getNumberGates();
+  const int evaluations = 2000000;   // per kernel and simulator, so that each timing is a few ms
+  static volatile long long sink = 0;
+
+  mt19937 gen(1);
+  vector<char> values(numGates);
+  for(int g = 0; g < numGates; g++) values[g] = gen() % 5;   // LOGIC_ZERO ... LOGIC_X
+
+  PatternSim blockSim(nl, PATTERNS_PER_BLOCK);
+  int numWords = blockSim.getNumberWords();
+  vector<patternWord> z(numGates * numWords), o(numGates * numWords), outZ(numWords), outO(numWords);
+  for(int i = 0; i < numGates * numWords; i++){
+    patternWord known = ((patternWord)gen() << 32) ^ gen();
+    patternWord bits = ((patternWord)gen() << 32) ^ gen();
+    z[i] = known & ~bits;
+    o[i] = known & bits;
+  }
+
+  // the gates using each kernel
+  vector<vector<int> > gatesOf(NUM_KERNELS);
+  for(int g = 0; g < numGates; g++)
+    if(nl->getType(g) != GATE_PI) gatesOf[nl->getKernel(g)].push_back(g);
+
+  cout << "Gate evaluation kernels (" << blockSim.getKernelName() << ", " << PATTERNS_PER_BLOCK << " patterns per bit-parallel evaluation)" << endl;
+  cout << "Type\tInputs\tGates\t5-valued ns: kernel/generic\tbit-parallel ns: kernel/generic" << endl;
+  for(int k = 0; k < NUM_KERNELS; k++){
+    const vector<int>& gates = gatesOf[k];
+    if(gates.empty()) continue;
+    char t = nl->getType(gates[0]);
+    int generic = Netlist::genericKernel(t);
+    int rounds = max(1, evaluations / (int)gates.size());
+    int numEvaluations = rounds * gates.size();
+
+    // Each result is summed into check (and then sink), so the compiler cannot drop the evaluations.
+    long long check = 0;
+    double logicTime[2], blockTime[2];
+    for(int pass = 0; pass < 2; pass++){
+      int kernel = (pass == 0) ? k : generic;
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      for(int r = 0; r < rounds; r++)
+        for(int g:gates) check += nl->evaluateWith(kernel, g, &values[0]);
+      logicTime[pass] = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+      int blockRounds = max(1, rounds / numWords);
+      start = chrono::steady_clock::now();
+      for(int r = 0; r < blockRounds; r++){
+        for(int g:gates){
+          blockSim.evaluateGateWith(kernel, g, &z[0], &o[0], &outZ[0], &outO[0]);
+          check += outZ[0] ^ outO[numWords-1];
+        }
+      }
+      blockTime[pass] = chrono::duration<double>(chrono::steady_clock::now() - start).count() / (blockRounds * gates.size()) * numEvaluations;
+      if(kernel == generic) break;
+    }
+
+    int n = nl->faninEnd(gates[0]) - nl->faninBegin(gates[0]);
+    cout << myCircuit->getGate(gates[0])->gateTypeName() << "\t" << ((k == generic) ? string("any") : to_string(n)) << "\t" << gates.size() << "\t";
+    cout << fixed << setprecision(2) << 1e9 * logicTime[0] / numEvaluations;
+    if(k != generic) cout << " / " << 1e9 * logicTime[1] / numEvaluations;
+    cout << "\t\t\t" << 1e9 * blockTime[0] / numEvaluations;
+    if(k != generic) cout << " / " << 1e9 * blockTime[1] / numEvaluations;
+    cout << endl;
+    sink += check;
+  }
+
+  // With -x, also compare a whole fault-free simulation with the interpreted and compiled code.
+  const CompiledSim* compiled = nl->getCompiledSim();
+  if(compiled != NULL){
+    vector<char> pattern(nl->getPIs().size());
+    for(int p = 0; p < blockSim.getNumberPatterns(); p++){
+      for(int i = 0; i < pattern.size(); i++) pattern[i] = gen() % 2;
+      blockSim.setPattern(p, pattern);
+    }
+    int runs = max(1, evaluations / numGates);
+    double simTime[2];
+    for(int pass = 0; pass < 2; pass++){
+      nl->setCompiledSim((pass == 0) ? NULL : compiled);
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      for(int r = 0; r < runs; r++){
+        blockSim.simulateGood();
+        sink += blockSim.getGoodZero(nl->getPOs()[0])[0];
+      }
+      simTime[pass] = chrono::duration<double>(chrono::steady_clock::now() - start).count() / runs;
+    }
+    cout << "Fault-free simulation of " << blockSim.getNumberPatterns() << " patterns, us: interpreted " << 1e6 * simTime[0]
+         << ", compiled " << 1e6 * simTime[1] << endl;
+  }
+}
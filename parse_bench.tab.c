@@ -83,7 +83,7 @@ using namespace std;
 Circuit* myCircuit = new Circuit;
  
 int gate_index=0, gate_ID_val=0;
-string temp, temp1;
+vector<int> inputSymbols;  // the interned input names of the gate being parsed, last one first
 int i=0;
  
  // stuff from flex that bison needs to know about:
@@ -92,13 +92,11 @@ int i=0;
  
  void yyerror(const char *str) { fprintf(stderr,"error: %s\n", str); } 
  int yywrap() { return 1; }
- 
- void process(string);
 
 
 
 /* Line 268 of yacc.c  */
-#line 102 "parse_bench.tab.c"
+#line 100 "parse_bench.tab.c"
 
 # ifndef YY_NULL
 #  if defined __cplusplus && 201103L <= __cplusplus
@@ -167,7 +165,7 @@ typedef union YYSTYPE
 
 
 /* Line 295 of yacc.c  */
-#line 171 "parse_bench.tab.c"
+#line 169 "parse_bench.tab.c"
 } YYSTYPE;
 # define YYSTYPE_IS_TRIVIAL 1
 # define yystype YYSTYPE /* obsolescent; will be withdrawn */
@@ -179,7 +177,7 @@ typedef union YYSTYPE
 
 
 /* Line 345 of yacc.c  */
-#line 183 "parse_bench.tab.c"
+#line 181 "parse_bench.tab.c"
 
 #ifdef short
 # undef short
@@ -473,8 +471,8 @@ static const yytype_int8 yyrhs[] =
 /* YYRLINE[YYN] -- source line where rule number YYN was defined.  */
 static const yytype_uint8 yyrline[] =
 {
-       0,    45,    45,    46,    50,    50,    50,    53,    61,    66,
-      78,    82,    92,    93,    94,    95,    96,    97,    99,   100
+       0,    43,    43,    44,    48,    48,    48,    51,    60,    66,
+      82,    86,    93,    94,    95,    96,    97,    98,   100,   101
 };
 #endif
 
@@ -1419,10 +1417,11 @@ yyreduce:
         case 7:
 
 /* Line 1810 of yacc.c  */
-#line 53 "parse_bench.y"
+#line 51 "parse_bench.y"
     {
 
       myCircuit->newGate((yyvsp[(3) - (4)].s), gate_ID_val, GATE_PI);
+      free((yyvsp[(3) - (4)].s));
       gate_ID_val=gate_ID_val+1;
       gate_index=gate_index+1;
     }
@@ -1431,9 +1430,10 @@ yyreduce:
   case 8:
 
 /* Line 1810 of yacc.c  */
-#line 61 "parse_bench.y"
+#line 60 "parse_bench.y"
     {
 	myCircuit->addOutputName((yyvsp[(3) - (4)].s));
+	free((yyvsp[(3) - (4)].s));
    }
     break;
 
@@ -1444,99 +1444,98 @@ yyreduce:
     {
 	int gateID = gate_ID_val;
 	int gateType = (yyvsp[(3) - (6)].gatetype);
-	string assign_out=(yyvsp[(1) - (6)].s);
 
 	myCircuit->newGate((yyvsp[(1) - (6)].s), gateID, gateType);
-	process(temp);
+	free((yyvsp[(1) - (6)].s));
+	Gate* g = myCircuit->getGate(gate_index);
+	for (int k=inputSymbols.size()-1; k>=0; k--)
+		g->set_gateInputSymbol(inputSymbols[k]);
+	inputSymbols.clear();
 	gate_index=gate_index+1;
 	gate_ID_val=gate_ID_val+1;
-	temp="";
     }
     break;
 
   case 10:
 
 /* Line 1810 of yacc.c  */
-#line 78 "parse_bench.y"
+#line 82 "parse_bench.y"
     {
-  temp=temp.append((yyvsp[(1) - (1)].s));
-  temp=temp.append(",");
+  inputSymbols.push_back(myCircuit->internName((yyvsp[(1) - (1)].s)));
+  free((yyvsp[(1) - (1)].s));
 }
     break;
 
   case 11:
 
 /* Line 1810 of yacc.c  */
-#line 83 "parse_bench.y"
+#line 87 "parse_bench.y"
     {
-  temp1=temp;
-  temp="";
-  temp=temp.append((yyvsp[(1) - (3)].s));		
-  temp=temp.append(",");
-  temp.append(temp1);
+  inputSymbols.push_back(myCircuit->internName((yyvsp[(1) - (3)].s)));
+  free((yyvsp[(1) - (3)].s));
 }
     break;
 
   case 12:
 
 /* Line 1810 of yacc.c  */
-#line 92 "parse_bench.y"
+#line 93 "parse_bench.y"
     {(yyval.gatetype)=GATE_NAND; }
     break;
 
   case 13:
 
 /* Line 1810 of yacc.c  */
-#line 93 "parse_bench.y"
+#line 94 "parse_bench.y"
     {(yyval.gatetype)=GATE_NOR; }
     break;
 
   case 14:
 
 /* Line 1810 of yacc.c  */
-#line 94 "parse_bench.y"
+#line 95 "parse_bench.y"
     {(yyval.gatetype)=GATE_AND; }
     break;
 
   case 15:
 
 /* Line 1810 of yacc.c  */
-#line 95 "parse_bench.y"
+#line 96 "parse_bench.y"
     {(yyval.gatetype)=GATE_OR; }
     break;
 
   case 16:
 
 /* Line 1810 of yacc.c  */
-#line 96 "parse_bench.y"
+#line 97 "parse_bench.y"
     {(yyval.gatetype)=GATE_XOR; }
     break;
 
   case 17:
 
 /* Line 1810 of yacc.c  */
-#line 97 "parse_bench.y"
+#line 98 "parse_bench.y"
     {(yyval.gatetype)=GATE_XNOR; }
     break;
 
   case 18:
 
 /* Line 1810 of yacc.c  */
-#line 99 "parse_bench.y"
+#line 100 "parse_bench.y"
     {(yyval.gatetype)=GATE_BUFF; }
     break;
 
   case 19:
 
 /* Line 1810 of yacc.c  */
-#line 100 "parse_bench.y"
+#line 101 "parse_bench.y"
     {(yyval.gatetype)=GATE_NOT; }
     break;
 
 
 
 /* Line 1810 of yacc.c  */
-#line 1540 "parse_bench.tab.c"
+#line 1539 "parse_bench.tab.c"
       default: break;
     }
   /* User semantic actions sometimes alter yychar, and that requires
@@ -1767,27 +1766,5 @@ yyreturn:
 
 
 /* Line 2071 of yacc.c  */
-#line 102 "parse_bench.y"
-
-
-void process(string id_list) {  
-  string input;
-  input = id_list;
-  
-  string temp_string="";
-  
-  for(int i=0; i<input.length(); i++) { // Stores input names of each gate in a vector     
-    if(input[i]!=',') {
-      stringstream ss;
-      ss << input[i];
-      string temp ;
-      ss >> temp;
-      temp_string=temp_string.append(temp);
-    }
-    else if(input[i]==',') {           	    
-      myCircuit->getGate(gate_index)->set_gateInputName(temp_string);
-      temp_string.clear();
-    }
-  }	
-}
+#line 103 "parse_bench.y"
 
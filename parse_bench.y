@@ -14,7 +14,7 @@ using namespace std;
 Circuit* myCircuit = new Circuit;
  
 int gate_index=0, gate_ID_val=0;
-string temp, temp1;
+vector<int> inputSymbols;  // the interned input names of the gate being parsed, last one first
 int i=0;
  
  // stuff from flex that bison needs to know about:
@@ -23,8 +23,6 @@ int i=0;
  
  void yyerror(const char *str) { fprintf(stderr,"error: %s\n", str); } 
  int yywrap() { return 1; }
- 
- void process(string);
 
 %}
 
@@ -53,6 +51,7 @@ input_line:
     INPUT LPAREN IDENTIFIER RPAREN {
 
       myCircuit->newGate($3, gate_ID_val, GATE_PI);
+      free($3);
       gate_ID_val=gate_ID_val+1;
       gate_index=gate_index+1;
     };
@@ -60,32 +59,34 @@ input_line:
 output_line:
     OUTPUT LPAREN IDENTIFIER RPAREN {
 	myCircuit->addOutputName($3);
+	free($3);
    };
 
 assign_line:
     IDENTIFIER EQUALS GATE LPAREN id_list RPAREN {
 	int gateID = gate_ID_val;
 	int gateType = $3;
-	string assign_out=$1;
 
 	myCircuit->newGate($1, gateID, gateType);
-	process(temp);
+	free($1);
+	Gate* g = myCircuit->getGate(gate_index);
+	for (int k=inputSymbols.size()-1; k>=0; k--)
+		g->set_gateInputSymbol(inputSymbols[k]);
+	inputSymbols.clear();
 	gate_index=gate_index+1;
 	gate_ID_val=gate_ID_val+1;
-	temp="";
     };
 
+// The list is right-recursive, so its names are reduced from the last one to the first.
+// Each is interned as soon as it is read; the gate keeps only the symbol IDs.
 id_list: IDENTIFIER {
-  temp=temp.append($1);
-  temp=temp.append(",");
+  inputSymbols.push_back(myCircuit->internName($1));
+  free($1);
 }
 | IDENTIFIER COMMA id_list 
 {
-  temp1=temp;
-  temp="";
-  temp=temp.append($1);		
-  temp=temp.append(",");
-  temp.append(temp1);
+  inputSymbols.push_back(myCircuit->internName($1));
+  free($1);
 };
 
 GATE:
@@ -100,24 +101,3 @@ GATE:
      | NOT {$$=GATE_NOT; }
 ;
 %%
-
-void process(string id_list) {  
-  string input;
-  input = id_list;
-  
-  string temp_string="";
-  
-  for(int i=0; i<input.length(); i++) { // Stores input names of each gate in a vector     
-    if(input[i]!=',') {
-      stringstream ss;
-      ss << input[i];
-      string temp ;
-      ss >> temp;
-      temp_string=temp_string.append(temp);
-    }
-    else if(input[i]==',') {           	    
-      myCircuit->getGate(gate_index)->set_gateInputName(temp_string);
-      temp_string.clear();
-    }
-  }	
-}
@@ -0,0 +1,70 @@
+// Checks that PODEM does not allocate per fault: every call to the global operator new is
+// counted while a PodemWorker targets both faults on every gate of c432, in each mode. The only
+// allocations allowed are the growth of the worker's reused buffers (D-frontier, event queue,
+// decision stack, value trail, X-path search) and of the test vector, which stop once they are
+// large enough for the circuit. So the count is bounded by a constant, MAX_ALLOCATIONS per mode,
+// however many faults are targeted or gates are evaluated.
+//
+// Build and run with "make test" (from the top directory, which has test/c432.bench). Prints
+// the count for each mode, and exits with status 1 if one is over the bound.
+
+#include "../ClassCircuit.h"
+#include "../ClassPodemWorker.h"
+#include <stdlib.h>  // malloc, free
+#include <stdio.h>   // fopen
+
+// The most allocations allowed in one mode, for the faults of all 432 gates of c432
+#define MAX_ALLOCATIONS 64
+
+// A few of c432's faults take minutes without a limit; a thousand backtracks still grow the buffers
+#define BACKTRACK_LIMIT 1000
+
+extern "C" int yyparse();
+extern FILE *yyin;
+extern Circuit* myCircuit;
+
+long long allocationCount = 0;
+void* operator new(size_t n) {
+	allocationCount++;
+	void* p = malloc(n);
+	if (p == NULL)
+		throw bad_alloc();
+	return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+
+int main() {
+	yyin = fopen("test/c432.bench", "r");
+	if (yyin == NULL) {
+		cout << "ERROR: cannot open test/c432.bench" << endl;
+		return 1;
+	}
+	yyparse();
+	fclose(yyin);
+	myCircuit->setupCircuit();
+	Netlist* nl = myCircuit->getNetlist();
+	nl->computeSCOAP();
+
+	int errors = 0;
+	const int modes[] = {1, 2, 3, 4, 6};
+	for (int i=0; i<sizeof(modes)/sizeof(modes[0]); i++) {
+		PodemWorker podem(nl, modes[i], BACKTRACK_LIMIT);
+		vector<char> test;
+		int faults = 0;
+		long long allocationsBefore = allocationCount;
+		for (int g=0; g<nl->getNumberGates(); g++) {
+			for (char f=FAULT_SA0; f<=FAULT_SA1; f++) {
+				if (podem.run(g, f) == PODEM_DETECTED)
+					podem.getTest(test);
+				faults++;
+			}
+		}
+		long long allocations = allocationCount - allocationsBefore;
+		cout << "Mode " << modes[i] << ": " << allocations << " allocations for " << faults << " faults" << endl;
+		if (allocations > MAX_ALLOCATIONS)
+			errors++;
+	}
+
+	cout << (errors ? "FAILED: " : "Passed: ") << errors << " modes over " << MAX_ALLOCATIONS << " allocations" << endl;
+	return errors ? 1 : 0;
+}
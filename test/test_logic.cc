@@ -0,0 +1,238 @@
+// Checks the Logic tables (ClassLogic.h) against the gate evaluation and fault injection they
+// replaced: the if-based helpers of the original main.cc, copied below. The only changes are a
+// return at the end of the functions that fell off it, and a stub for setGateOutputs(), which
+// they call on an unset input (the test never leaves one unset).
+//
+// Every gate type is tried with every combination of the five values on 1 to 4 inputs (BUFF,
+// NOT and FANOUT on 1 input), and every fault with every value. The original XOR and XNOR only
+// looked at two inputs, so wider ones are checked against a chain of two-input XORs.
+//
+// Build and run with "make test". Prints the mismatches, and exits with status 1 if there are any.
+
+#include "../ClassLogic.h"
+
+static const string testName = "test";
+
+void setGateOutputs(vector<Gate*>&) { assert(false); }
+
+//////////////////////////////////////////////////////////////////////
+// From the original main.cc
+
+  // This function is used to set a D or a DBAR if
+  // there is an error at the gate output
+  void setValueForError(int result, Gate* gate){
+    if(gate->get_faultType() == FAULT_SA0 && result == LOGIC_ONE){
+      gate->setValue(LOGIC_D);
+    }else if(gate->get_faultType() == FAULT_SA1 && result == LOGIC_ZERO){
+      gate->setValue(LOGIC_DBAR);
+    }else{
+      gate->setValue(result);
+    }
+  }
+
+  int handleExclusiveGates(vector<Gate*>& gates, int gateType);
+  int handleNot(vector<Gate*>& gates);
+  int handleBuffFanout(vector<Gate*>& gates);
+  bool isControllingValue(int input, int gateType);
+  int controllingOutput(int gateType);
+  int nonControllingOutput(int gateType);
+
+  //Find the gate output value based on the input. The function also has a
+  //recursive call if the required values are not set
+  int findGateValue(vector<Gate*>& gates, int gateType){
+    int noOfGates = gates.size();
+    bool xValue = false, dValue = false, dbarValue = false;
+    if(gateType == GATE_XOR || gateType == GATE_XNOR){
+      return handleExclusiveGates(gates, gateType);
+    }
+    if(gateType == GATE_NOT){
+      return handleNot(gates);
+    }
+    if(gateType == GATE_BUFF || gateType == GATE_FANOUT){
+      return handleBuffFanout(gates);
+    }
+
+    // AND, OR, NAND, NOR gates
+    for(int i=0; i<noOfGates; i++){
+      if(gates[i]->getValue() == LOGIC_UNSET) setGateOutputs(gates);
+      if(gates[i]->getValue() == LOGIC_X){
+        xValue = true;
+      }
+      else if(gates[i]->getValue() == LOGIC_D){
+        dValue = true;
+      }
+      else if(gates[i]->getValue() == LOGIC_DBAR){
+        dbarValue = true;
+      }
+      else if(isControllingValue(gates[i]->getValue(), gateType)) return controllingOutput(gateType);
+    }
+
+    // D or DBAR means one of the values if a controlling value hence
+    // return the controlling output
+    if(dValue && dbarValue ) return controllingOutput(gateType);
+
+    //If there is no controlling value and an X value output is X
+    if(xValue) return LOGIC_X;
+
+    // D values and non-controlling values
+    if(dValue && (gateType == GATE_AND || gateType == GATE_OR)) return LOGIC_D;
+    if(dbarValue && (gateType == GATE_AND || gateType == GATE_OR)) return LOGIC_DBAR;
+
+    // DBAR values and non-controlling values
+    if(dValue && (gateType == GATE_NAND || gateType == GATE_NOR)) return LOGIC_DBAR;
+    if(dbarValue && (gateType == GATE_NAND || gateType == GATE_NOR)) return LOGIC_D;
+
+    // else case where all values are non controlling values
+    return nonControllingOutput(gateType);
+  }
+
+  //check if input value is a controlling value based on the gate
+  bool isControllingValue(int input, int gateType){
+    if((gateType == GATE_NAND || gateType == GATE_AND) && input == LOGIC_ZERO) return true;
+    if((gateType == GATE_NOR || gateType == GATE_OR) && input == LOGIC_ONE) return true;
+    return false;
+  }
+
+  //Return the controlling values of the gates
+  int controllingOutput(int gateType){
+    if(gateType == GATE_NAND) return LOGIC_ONE;
+    if(gateType == GATE_AND) return LOGIC_ZERO;
+    if(gateType == GATE_NOR) return LOGIC_ZERO;
+    if(gateType == GATE_OR) return LOGIC_ONE;
+    return LOGIC_UNSET;
+  }
+
+  //Return the non-controlling output values of the gates
+  int nonControllingOutput(int gateType){
+    if(gateType == GATE_NAND) return LOGIC_ZERO;
+    if(gateType == GATE_AND) return LOGIC_ONE;
+    if(gateType == GATE_NOR) return LOGIC_ONE;
+    if(gateType == GATE_OR) return LOGIC_ZERO;
+    return LOGIC_UNSET;
+  }
+
+  // Speacial Function to handle XOR and XNOR
+  int handleExclusiveGates(vector<Gate*>& gates, int gateType){
+    if(gates[0]->getValue() == LOGIC_UNSET) setGateOutputs(gates);
+    if(gates[1]->getValue() == LOGIC_UNSET) setGateOutputs(gates);
+    bool xValue = false, ones = false, zeros = false, dValue = false, dbarValue = false;
+    for(int i=0; i<2; i++){
+      if(gates[i]->getValue() == LOGIC_X) return LOGIC_X;
+      if(gates[i]->getValue() == LOGIC_ONE) ones = true;
+      if(gates[i]->getValue() == LOGIC_ZERO) zeros = true;
+      if(gates[i]->getValue() == LOGIC_D) dValue = true;
+      if(gates[i]->getValue() == LOGIC_DBAR) dbarValue = true;
+    }
+    // 1 & 0
+    if(zeros && ones && gateType == GATE_XOR) return LOGIC_ONE;
+    if(zeros && ones && gateType == GATE_XNOR) return LOGIC_ZERO;
+    // 0 & D
+    if(zeros && dValue && gateType == GATE_XOR) return LOGIC_D;
+    if(zeros && dValue && gateType == GATE_XNOR) return LOGIC_DBAR;
+    // 1 & D
+    if(ones && dValue && gateType == GATE_XOR) return LOGIC_DBAR;
+    if(ones && dValue && gateType == GATE_XNOR) return LOGIC_D;
+    // 0 & DBAR
+    if(zeros && dbarValue && gateType == GATE_XOR) return LOGIC_DBAR;
+    if(zeros && dbarValue && gateType == GATE_XNOR) return LOGIC_D;
+    // 1 & DBAR
+    if(ones && dbarValue && gateType == GATE_XOR) return LOGIC_D;
+    if(ones && dbarValue && gateType == GATE_XNOR) return LOGIC_DBAR;
+    // D & DBAR
+    if(dValue && dbarValue && gateType == GATE_XOR) return LOGIC_ONE;
+    if(dValue && dbarValue && gateType == GATE_XNOR) return LOGIC_ZERO;
+    // else both the logics are same in that case we need to return 0 for XOR and 1 XNOR
+    if(gateType == GATE_XOR) return LOGIC_ZERO;
+    return LOGIC_ONE;
+  }
+
+  // speacial function to handle NOT gate
+  // return the complement of the input value
+  int handleNot(vector<Gate*>& gates){
+    if(gates[0]->getValue() == LOGIC_UNSET) setGateOutputs(gates);
+    if(gates[0]->getValue() == LOGIC_ONE) return LOGIC_ZERO;
+    if(gates[0]->getValue() == LOGIC_ZERO) return LOGIC_ONE;
+    if(gates[0]->getValue() == LOGIC_X) return LOGIC_X;
+    if(gates[0]->getValue() == LOGIC_D) return LOGIC_DBAR;
+    return LOGIC_D;
+  }
+
+  // Speacial function to handle BUFF and FANOUT gates
+  // Return the input values as is
+  int handleBuffFanout(vector<Gate*>& gates){
+    if(gates[0]->getValue() == LOGIC_UNSET) setGateOutputs(gates);
+    return gates[0]->getValue();
+  }
+
+// End of the original main.cc
+//////////////////////////////////////////////////////////////////////
+
+/** \brief The original evaluation of a gate of type \a t on \a inputs; XOR and XNOR of more than two inputs are chained. */
+int referenceValue(vector<Gate*>& inputs, int t) {
+	if (((t != GATE_XOR) && (t != GATE_XNOR)) || (inputs.size() <= 2))
+		return findGateValue(inputs, t);
+
+	Gate partial(&testName, 0, GATE_XOR);
+	partial.setValue(inputs[0]->getValue());
+	for (int i=1; i<inputs.size(); i++) {
+		vector<Gate*> pair;
+		pair.push_back(&partial);
+		pair.push_back(inputs[i]);
+		partial.setValue(findGateValue(pair, GATE_XOR));
+	}
+	if (t == GATE_XOR)
+		return partial.getValue();
+	vector<Gate*> single(1, &partial);
+	return handleNot(single);
+}
+
+int main() {
+	int errors = 0;
+	const char types[] = {GATE_NAND, GATE_NOR, GATE_AND, GATE_OR, GATE_XOR, GATE_XNOR, GATE_BUFF, GATE_NOT, GATE_FANOUT};
+	Gate g0(&testName, 0, GATE_PI), g1(&testName, 1, GATE_PI), g2(&testName, 2, GATE_PI), g3(&testName, 3, GATE_PI);
+	Gate* pool[] = {&g0, &g1, &g2, &g3};
+
+	for (int i=0; i<sizeof(types); i++) {
+		char t = types[i];
+		int maxInputs = ((t == GATE_BUFF) || (t == GATE_NOT) || (t == GATE_FANOUT)) ? 1 : 4;
+		for (int n=1; n<=maxInputs; n++) {
+			// the original XOR and XNOR need two inputs
+			if (((t == GATE_XOR) || (t == GATE_XNOR)) && (n < 2))
+				continue;
+			int combinations = 1;
+			for (int j=0; j<n; j++)
+				combinations *= 5;
+			for (int c=0; c<combinations; c++) {
+				vector<Gate*> inputs(pool, pool + n);
+				int s = Logic::start(t);
+				for (int j=0, rest=c; j<n; j++, rest/=5) {
+					inputs[j]->setValue(rest % 5);
+					s = Logic::fold(t, s, rest % 5);
+				}
+				if (Logic::output(t, s) != referenceValue(inputs, t)) {
+					cout << "ERROR: gate type " << (int)t << " on";
+					for (int j=0; j<n; j++)
+						cout << " " << inputs[j]->printValue();
+					cout << ": table " << (int)Logic::output(t, s) << ", original " << referenceValue(inputs, t) << endl;
+					errors++;
+				}
+			}
+		}
+	}
+
+	for (int f=NOFAULT; f<=FAULT_SA1; f++) {
+		for (int v=LOGIC_UNSET; v<=LOGIC_X; v++) {
+			Gate faulty(&testName, 0, GATE_BUFF);
+			faulty.set_faultType(f);
+			setValueForError(v, &faulty);
+			if (Logic::injectFault(f, v) != faulty.getValue()) {
+				cout << "ERROR: fault " << f << " on value " << v << ": table " << (int)Logic::injectFault(f, v)
+				     << ", original " << (int)faulty.getValue() << endl;
+				errors++;
+			}
+		}
+	}
+
+	cout << (errors ? "FAILED: " : "Passed: ") << errors << " mismatches" << endl;
+	return errors ? 1 : 0;
+}